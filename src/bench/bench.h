@@ -0,0 +1,13 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <string>
+
+// 以加载器(非Qt)的方式解析desktop文件并读取Exec、Categories，返回读取到的数据量
+size_t loaderParse(const std::string &path);
+
+#endif // BENCH_H
@@ -0,0 +1,19 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// 加载器不定义USE_QT，这里使用与其相同的DesktopDeconstruction实现
+#undef USE_QT
+#include "../modules/tools/desktop_deconstruction.hpp"
+
+#include "bench.h"
+
+size_t loaderParse(const std::string &path)
+{
+    DesktopDeconstruction dd(path);
+    dd.beginGroup("Desktop Entry");
+    const std::string exec = dd.value<std::string>("Exec");
+    const std::vector<std::string> categories = dd.value<std::vector<std::string>>("Categories");
+    dd.endGroup();
+    return exec.size() + categories.size();
+}
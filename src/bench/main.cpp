@@ -0,0 +1,418 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/*
+ * dam-bench: desktop文件处理热点路径的基准测试
+ * 每个用例输出一行JSON，字段含义:
+ *   bench            用例名
+ *   unit             样本粒度，entry为单个条目，pass为一次处理整个语料
+ *   entries          每次pass处理的条目数
+ *   samples          样本数
+ *   throughput       每秒处理的条目数
+ *   p50_ns/p99_ns    单个样本的耗时
+ *   allocs_per_entry 每个条目的堆分配次数(malloc/calloc/realloc)
+ */
+
+#include "bench.h"
+#include "keyfile.h"
+#include "desktopinfo.h"
+#include "desktopentrycache.h"
+#include "launcher.h"
+#include "category.h"
+#include "desktopexec.h"
+#include "../modules/methods/task.hpp"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+static std::atomic<uint64_t> allocCount(0);
+
+// 替换glibc的分配函数以统计分配次数，Qt容器直接使用malloc，只统计operator new是不够的
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t n, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+
+void *malloc(size_t size)
+{
+    allocCount.fetch_add(1, std::memory_order_relaxed);
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t n, size_t size)
+{
+    allocCount.fetch_add(1, std::memory_order_relaxed);
+    return __libc_calloc(n, size);
+}
+
+void *realloc(void *ptr, size_t size)
+{
+    allocCount.fetch_add(1, std::memory_order_relaxed);
+    return __libc_realloc(ptr, size);
+}
+}
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+struct Options {
+    QString filter;
+    int rounds = 20;
+};
+
+struct Corpus {
+    std::vector<std::string> paths;
+    std::vector<QString> categories;
+    std::vector<QString> execLines;
+};
+
+const char *const Locales[] = {
+    "ar", "bo", "ca", "cs", "da", "de", "el", "es", "fi", "fr", "hu", "it", "ja",
+    "ko", "nl", "pl", "pt", "pt_BR", "ru", "sv", "tr", "uk", "zh_CN", "zh_HK", "zh_TW",
+};
+
+const char *const CategorySets[] = {
+    "Network;WebBrowser;",
+    "Office;WordProcessor;X-Deepin-Office;",
+    "AudioVideo;Audio;Player;",
+    "Graphics;2DGraphics;RasterGraphics;",
+    "Development;IDE;TextEditor;",
+    "Game;ArcadeGame;",
+    "System;Settings;X-GNOME-Settings-Panel;",
+    "Utility;Archiving;Compression;",
+    "Education;Science;Math;",
+    "qt;kde;Network;Chat;InstantMessaging;",
+};
+
+const char *const ExecLines[] = {
+    "sh %U",
+    "sh -c \"exec true\" %f",
+    "env LANG=C sh %F",
+    "sh --new-window %u",
+    "sh",
+    "sh --icon %i --class %c %k",
+};
+
+bool enabled(const Options &options, const char *name)
+{
+    return options.filter.isEmpty() || QString(name).contains(options.filter);
+}
+
+void report(const char *name, const char *unit, size_t entries, std::vector<int64_t> &samples,
+            int64_t totalNs, uint64_t allocs, size_t processed)
+{
+    if (samples.empty() || processed == 0)
+        return;
+
+    std::sort(samples.begin(), samples.end());
+    const int64_t p50 = samples[(samples.size() - 1) * 50 / 100];
+    const int64_t p99 = samples[(samples.size() - 1) * 99 / 100];
+    const double throughput = totalNs > 0 ? processed * 1e9 / totalNs : 0;
+
+    printf("{\"bench\":\"%s\",\"unit\":\"%s\",\"entries\":%zu,\"samples\":%zu,\"throughput\":%.1f,"
+           "\"p50_ns\":%lld,\"p99_ns\":%lld,\"allocs_per_entry\":%.2f}\n",
+           name, unit, entries, samples.size(), throughput, static_cast<long long>(p50),
+           static_cast<long long>(p99), static_cast<double>(allocs) / processed);
+    fflush(stdout);
+}
+
+// 逐条目计时，每个样本为处理一个条目
+template<typename Func>
+void benchEntries(const Options &options, const char *name, size_t count, Func func)
+{
+    if (!enabled(options, name) || count == 0)
+        return;
+
+    for (size_t i = 0; i < count; ++i)
+        func(i); // 预热
+
+    std::vector<int64_t> samples;
+    samples.reserve(count * options.rounds);
+    int64_t totalNs = 0;
+    uint64_t allocs = 0;
+    for (int round = 0; round < options.rounds; ++round) {
+        for (size_t i = 0; i < count; ++i) {
+            const uint64_t before = allocCount.load(std::memory_order_relaxed);
+            const auto begin = Clock::now();
+            func(i);
+            const int64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - begin).count();
+            allocs += allocCount.load(std::memory_order_relaxed) - before;
+            totalNs += ns;
+            samples.push_back(ns);
+        }
+    }
+
+    report(name, "entry", count, samples, totalNs, allocs, count * options.rounds);
+}
+
+// 整体计时，每个样本为处理一次整个语料，func返回处理的条目数
+template<typename Func>
+void benchPasses(const Options &options, const char *name, Func func)
+{
+    if (!enabled(options, name))
+        return;
+
+    const size_t entries = func(); // 预热
+    std::vector<int64_t> samples;
+    samples.reserve(options.rounds);
+    int64_t totalNs = 0;
+    uint64_t allocs = 0;
+    for (int round = 0; round < options.rounds; ++round) {
+        const uint64_t before = allocCount.load(std::memory_order_relaxed);
+        const auto begin = Clock::now();
+        func();
+        const int64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - begin).count();
+        allocs += allocCount.load(std::memory_order_relaxed) - before;
+        totalNs += ns;
+        samples.push_back(ns);
+    }
+
+    report(name, "pass", entries, samples, totalNs, allocs, entries * options.rounds);
+}
+
+// loader领取任务的一次往返: 编码Task，经socketpair传输后解码，成功返回1
+size_t wireRoundTrip(const int fds[2], const Methods::Task &task, bool json)
+{
+    const std::vector<char> frame = Methods::Wire::encode(task, json);
+    for (size_t written = 0; written < frame.size();) {
+        const ssize_t n = write(fds[0], frame.data() + written, frame.size() - written);
+        if (n <= 0)
+            return 0;
+
+        written += size_t(n);
+    }
+
+    std::vector<char> received(frame.size());
+    for (size_t offset = 0; offset < received.size();) {
+        const ssize_t n = read(fds[1], received.data() + offset, received.size() - offset);
+        if (n <= 0)
+            return 0;
+
+        offset += size_t(n);
+    }
+
+    Methods::Task result;
+    return Methods::Wire::decode(received, result) && result.environments.size() == task.environments.size() ? 1 : 0;
+}
+
+// 生成带多语言字段、Actions及各种Exec写法的desktop文件
+QByteArray syntheticEntry(int index)
+{
+    QByteArray data;
+    data += "# generated by dam-bench\n[Desktop Entry]\nType=Application\nVersion=1.0\n";
+    data += "Name=Synthetic App " + QByteArray::number(index) + "\n";
+    for (const char *locale : Locales)
+        data += QByteArray("Name[") + locale + "]=Synthetic " + locale + " " + QByteArray::number(index) + "\n";
+    data += "GenericName=Synthetic Tool\n";
+    for (const char *locale : Locales)
+        data += QByteArray("GenericName[") + locale + "]=Tool " + locale + "\n";
+    data += "Comment=A generated application used by dam-bench\n";
+    for (const char *locale : Locales)
+        data += QByteArray("Comment[") + locale + "]=Comment " + locale + "\n";
+    data += "Keywords=synthetic;bench;app" + QByteArray::number(index) + ";\n";
+    data += "Icon=synthetic-app-" + QByteArray::number(index) + "\n";
+    data += QByteArray("Exec=") + ExecLines[index % (sizeof(ExecLines) / sizeof(ExecLines[0]))] + "\n";
+    if (index % 10 == 7)
+        data += "TryExec=dam-bench-missing-" + QByteArray::number(index) + "\n";
+    if (index % 13 == 5)
+        data += "NoDisplay=true\n";
+    data += "Terminal=false\nStartupNotify=true\n";
+    data += QByteArray("Categories=") + CategorySets[index % (sizeof(CategorySets) / sizeof(CategorySets[0]))] + "\n";
+    data += "MimeType=text/plain;image/png;x-scheme-handler/http;\n";
+    data += "Actions=new-window;private;\n";
+    data += "\n[Desktop Action new-window]\nName=New Window\n";
+    for (const char *locale : Locales)
+        data += QByteArray("Name[") + locale + "]=New Window " + locale + "\n";
+    data += "Exec=sh --new-window %U\n";
+    data += "\n[Desktop Action private]\nName=Private Window\nExec=sh --private %U\n";
+    return data;
+}
+
+bool prepareCorpus(const QString &root, const QString &realDir, int synthetic, Corpus &corpus)
+{
+    const QString appDir = root + "/data/applications";
+    if (!QDir().mkpath(appDir) || !QDir().mkpath(root + "/dirs") || !QDir().mkpath(root + "/cache"))
+        return false;
+
+    for (int i = 0; i < synthetic; ++i) {
+        QFile file(QString("%1/synthetic-%2.desktop").arg(appDir).arg(i));
+        if (!file.open(QIODevice::WriteOnly))
+            return false;
+
+        file.write(syntheticEntry(i));
+    }
+
+    if (!realDir.isEmpty()) {
+        const QDir dir(realDir);
+        for (const QString &name : dir.entryList({"*.desktop"}, QDir::Files | QDir::Readable, QDir::Name))
+            QFile::copy(dir.filePath(name), appDir + "/real-" + name);
+    }
+
+    // 在初始化任何单例之前切换到语料目录，避免读写用户的数据和缓存
+    qputenv("XDG_DATA_HOME", QFile::encodeName(root + "/data"));
+    qputenv("XDG_DATA_DIRS", QFile::encodeName(root + "/dirs"));
+    qputenv("XDG_CACHE_HOME", QFile::encodeName(root + "/cache"));
+
+    for (const QString &name : QDir(appDir).entryList({"*.desktop"}, QDir::Files, QDir::Name)) {
+        const std::string path = (appDir + "/" + name).toStdString();
+        KeyFile keyFile;
+        if (!keyFile.loadFile(path))
+            continue;
+
+        corpus.paths.push_back(path);
+        corpus.categories.push_back(QString::fromStdString(keyFile.getStr(MainSection, "Categories")));
+        corpus.execLines.push_back(QString::fromStdString(keyFile.getStr(MainSection, "Exec")));
+    }
+
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    app.setApplicationName("dam-bench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Benchmarks for the desktop entry pipeline, one JSON object per line.");
+    parser.addHelpOption();
+    QCommandLineOption corpusOption("corpus", "Directory of real-world desktop files.", "dir", "/usr/share/applications");
+    QCommandLineOption syntheticOption("synthetic", "Number of generated desktop files.", "count", "500");
+    QCommandLineOption roundsOption("rounds", "Measured rounds per benchmark.", "count", "20");
+    QCommandLineOption filterOption("filter", "Only run benchmarks whose name contains this string.", "name");
+    QCommandLineOption langOption("lang", "LANGUAGE used for localized lookups.", "list", "zh_CN:en");
+    parser.addOptions({corpusOption, syntheticOption, roundsOption, filterOption, langOption});
+    parser.process(app);
+
+    Options options;
+    options.filter = parser.value(filterOption);
+    options.rounds = std::max(1, parser.value(roundsOption).toInt());
+
+    // 语言在第一次查询时确定，需在生成语料之前设置
+    qputenv("LANGUAGE", parser.value(langOption).toLocal8Bit());
+
+    QTemporaryDir root;
+    Corpus corpus;
+    if (!root.isValid() || !prepareCorpus(root.path(), parser.value(corpusOption),
+                                          parser.value(syntheticOption).toInt(), corpus)) {
+        fprintf(stderr, "failed to prepare corpus\n");
+        return 1;
+    }
+
+    const size_t count = corpus.paths.size();
+
+    benchEntries(options, "keyfile_load", count, [&](size_t i) {
+        KeyFile keyFile;
+        keyFile.loadFile(corpus.paths[i]);
+    });
+
+    benchEntries(options, "keyfile_read", count, [&](size_t i) {
+        KeyFile keyFile;
+        keyFile.readFile(corpus.paths[i]);
+    });
+
+    if (enabled(options, "desktop_entry_cache")) {
+        // 先写入缓存文件，测量的是之后启动时的命中路径
+        for (const std::string &path : corpus.paths) {
+            KeyFile keyFile;
+            DesktopEntryCache::instance()->loadFile(path, keyFile);
+        }
+        DesktopEntryCache::instance()->save();
+    }
+    benchEntries(options, "desktop_entry_cache", count, [&](size_t i) {
+        KeyFile keyFile;
+        DesktopEntryCache::instance()->loadFile(corpus.paths[i], keyFile);
+    });
+
+    benchEntries(options, "desktopinfo_ctor", count, [&](size_t i) {
+        DesktopInfo info(corpus.paths[i]);
+    });
+
+    std::vector<KeyFile> keyFiles(count);
+    for (size_t i = 0; i < count; ++i)
+        keyFiles[i].loadFile(corpus.paths[i]);
+    benchEntries(options, "get_locale_str", count, [&](size_t i) {
+        keyFiles[i].getLocaleStr(MainSection, "Name");
+        keyFiles[i].getLocaleStr(MainSection, "Comment");
+    });
+    keyFiles.clear();
+
+    benchEntries(options, "loader_parse", count, [&](size_t i) {
+        loaderParse(corpus.paths[i]);
+    });
+
+    benchEntries(options, "category_parse", count, [&](size_t i) {
+        Category::parseXCategoryString(corpus.categories[i]);
+    });
+
+    const QStringList noFiles;
+    const QStringList oneFile {"/tmp/dam-bench/a.txt"};
+    const QStringList urls {"file:///tmp/dam-bench/a.txt", "file:///tmp/dam-bench/b.txt"};
+    const DesktopExec::Entry entry {"bench", "Bench", "/tmp/dam-bench/bench.desktop"};
+    benchEntries(options, "exec_tokenize", count, [&](size_t i) {
+        DesktopExec exec(corpus.execLines[i]);
+    });
+
+    // 命中缓存后每次启动只有展开的开销
+    benchEntries(options, "exec_expand", count, [&](size_t i) {
+        DesktopExec::cached(corpus.execLines[i])->expand(i % 3 == 0 ? noFiles : (i % 3 == 1 ? oneFile : urls), entry);
+    });
+
+    // 与会话环境规模相当的任务
+    Methods::Task task;
+    task.id = "0123456789abcdef0123456789abcdef";
+    task.runId = "freedesktop/bench/bench";
+    task.filePath = "/tmp/dam-bench/bench.desktop";
+    task.date = "1700000000";
+    task.arguments = QStringList {"/usr/bin/bench", "--new-window", "file:///tmp/dam-bench/a.txt"};
+    for (int i = 0; i < 80; ++i)
+        task.environments.insert(QString("DAM_BENCH_VAR_%1").arg(i), QString("/usr/share/dam-bench/value/%1").arg(i));
+
+    int fds[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds) == 0) {
+        benchPasses(options, "wire_task_roundtrip", [&] {
+            return wireRoundTrip(fds, task, false);
+        });
+
+        benchPasses(options, "wire_task_roundtrip_json", [&] {
+            return wireRoundTrip(fds, task, true);
+        });
+
+        close(fds[0]);
+        close(fds[1]);
+    }
+
+    benchPasses(options, "apps_dir_scan", [] {
+        return AppsDir::getAllDesktopInfos().size();
+    });
+
+    benchPasses(options, "apps_dir_scan_serial", [] {
+        return AppsDir::getAllDesktopInfos(1).size();
+    });
+
+    if (enabled(options, "launcher_init_items")) {
+        Launcher launcher(nullptr);
+        benchPasses(options, "launcher_init_items", [&] {
+            launcher.initItems();
+            return count;
+        });
+    }
+
+    return 0;
+}
@@ -6,6 +6,7 @@
 #include "utils.h"
 #include "dlocale.h"
 #include "appinfocommon.h"
+#include "desktopentrycache.h"
 
 #include <string>
 #include <gio/gio.h>
@@ -89,7 +90,7 @@ std::shared_ptr<AppInfoManger> AppInfoManger::initAppInfoByFile(std::string file
     std::shared_ptr<AppInfoManger> appInfo;
     KeyFile keyFile;
 
-    bool bSuccess = keyFile.loadFile(fileName);
+    bool bSuccess = DesktopEntryCache::instance()->loadFile(fileName, keyFile);
     if (!bSuccess) {
         return appInfo;
     }
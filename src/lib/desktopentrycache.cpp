@@ -0,0 +1,636 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "desktopentrycache.h"
+#include "basedir.h"
+#include "dstring.h"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <unordered_map>
+
+/*
+ * 缓存文件格式(本机字节序，所有记录8字节对齐):
+ * Header | FileRecord[fileCount] | DirRecord[dirCount] | StrRef[sectionCount]
+ *        | EntryRecord[entryCount] | StrRef[nameCount] | 字符串池
+ * FileRecord与DirRecord均按路径排序，便于二分查找
+ */
+namespace {
+
+const char CacheMagic[8] = {'D', 'A', 'M', 'D', 'E', 'C', '\0', '\0'};
+const uint32_t CacheVersion = 2;
+
+const uint32_t FlagParsed = 1 << 0;
+
+struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t fileCount;
+    uint32_t dirCount;
+    uint32_t sectionCount;
+    uint32_t entryCount;
+    uint32_t nameCount;
+    uint64_t poolSize;
+};
+
+} // namespace
+
+struct DesktopEntryCache::StrRef {
+    uint32_t offset;
+    uint32_t length;
+};
+
+struct DesktopEntryCache::EntryRecord {
+    StrRef section;
+    StrRef key;
+    StrRef value;
+};
+
+struct DesktopEntryCache::FileRecord {
+    StrRef path;
+    uint64_t ino;
+    int64_t mtimeSec;
+    int64_t mtimeNsec;
+    int64_t size;
+    uint32_t flags;
+    uint32_t firstSection;
+    uint32_t sectionCount;
+    uint32_t firstEntry;
+    uint32_t entryCount;
+    uint32_t reserved;
+};
+
+struct DesktopEntryCache::DirRecord {
+    StrRef path;
+    uint64_t ino;
+    int64_t mtimeSec;
+    int64_t mtimeNsec;
+    int64_t size;
+    uint32_t firstName;
+    uint32_t nameCount;
+};
+
+namespace {
+
+// 写缓存时使用的字符串池，相同字符串只保存一份
+class PoolWriter
+{
+public:
+    template<typename Ref>
+    Ref add(std::string_view str)
+    {
+        auto iter = m_index.find(str);
+        if (iter != m_index.end())
+            return Ref{iter->second.first, iter->second.second};
+
+        uint32_t offset = uint32_t(m_pool.size());
+        m_pool.append(str.data(), str.size());
+        m_index.insert({str, {offset, uint32_t(str.size())}});
+        return Ref{offset, uint32_t(str.size())};
+    }
+
+    const std::string &data() const
+    {
+        return m_pool;
+    }
+
+private:
+    std::string m_pool;
+    // key引用的字符串在写缓存期间一直有效
+    std::unordered_map<std::string_view, std::pair<uint32_t, uint32_t>> m_index;
+};
+
+bool makeDirs(const std::string &dir)
+{
+    std::string path;
+    for (const auto &part : DString::splitStr(dir, '/')) {
+        if (part.empty())
+            continue;
+
+        path += "/" + part;
+        if (mkdir(path.c_str(), 0755) < 0 && errno != EEXIST)
+            return false;
+    }
+
+    return true;
+}
+
+std::string childPath(const std::string &dir, const std::string &name)
+{
+    if (!dir.empty() && dir.back() == '/')
+        return dir + name;
+
+    return dir + "/" + name;
+}
+
+template<typename T>
+bool writeArray(FILE *file, const std::vector<T> &array)
+{
+    return array.empty() || fwrite(array.data(), sizeof(T), array.size(), file) == array.size();
+}
+
+} // namespace
+
+template<typename Record>
+DesktopEntryCache::FileStat DesktopEntryCache::recordStat(const Record *record)
+{
+    FileStat st;
+    st.ino = record->ino;
+    st.mtimeSec = record->mtimeSec;
+    st.mtimeNsec = record->mtimeNsec;
+    st.size = record->size;
+    return st;
+}
+
+bool DesktopEntryCache::FileStat::operator==(const FileStat &other) const
+{
+    return ino == other.ino && mtimeSec == other.mtimeSec && mtimeNsec == other.mtimeNsec && size == other.size;
+}
+
+DesktopEntryCache *DesktopEntryCache::instance()
+{
+    static DesktopEntryCache instance;
+    return &instance;
+}
+
+DesktopEntryCache::DesktopEntryCache()
+ : m_fileRecords(nullptr)
+ , m_fileCount(0)
+ , m_dirRecords(nullptr)
+ , m_dirCount(0)
+ , m_sectionRefs(nullptr)
+ , m_entryRecords(nullptr)
+ , m_nameRefs(nullptr)
+ , m_pool(nullptr)
+ , m_dirty(false)
+{
+    std::string cacheDir = BaseDir::userCacheDir();
+    if (!cacheDir.empty())
+        m_cacheFile = cacheDir + "deepin/dde-application-manager/desktop-entry.cache";
+
+    loadCache();
+}
+
+bool DesktopEntryCache::loadFile(const std::string &filePath, KeyFile &keyFile)
+{
+    FileStat st;
+    if (!statPath(filePath, st)) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_files.erase(filePath) > 0 || findFileRecord(filePath)) {
+            m_removed.insert(filePath);
+            markDirty();
+        }
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto iter = m_files.find(filePath);
+        if (iter != m_files.end()) {
+            if (iter->second.stat == st) {
+                if (iter->second.parsed)
+                    keyFile = iter->second.keyFile;
+
+                return iter->second.parsed;
+            }
+        } else if (const FileRecord *record = findFileRecord(filePath)) {
+            if (recordStat(record) == st) {
+                if (!(record->flags & FlagParsed))
+                    return false;
+
+                fillKeyFile(record, keyFile);
+                return true;
+            }
+        }
+    }
+
+    // 缓存未命中，解析时不持锁，允许多个线程同时解析不同的文件
+    FileData data;
+    data.stat = st;
+    data.parsed = data.keyFile.readFile(filePath);
+    if (data.parsed)
+        keyFile = data.keyFile;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_files[filePath] = data;
+    m_removed.erase(filePath);
+    markDirty();
+
+    return data.parsed;
+}
+
+std::vector<std::string> DesktopEntryCache::listDir(const std::string &dirPath)
+{
+    FileStat st;
+    if (!statPath(dirPath, st))
+        return {};
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto iter = m_dirs.find(dirPath);
+        if (iter != m_dirs.end()) {
+            if (iter->second.stat == st)
+                return iter->second.names;
+        } else if (const DirRecord *record = findDirRecord(dirPath)) {
+            if (recordStat(record) == st)
+                return recordNames(record);
+        }
+    }
+
+    DirData data;
+    data.stat = st;
+
+    DIR *dp = opendir(dirPath.c_str());
+    if (!dp) {
+        std::cout << "Couldn't open directory " << dirPath << std::endl;
+        return {};
+    }
+
+    struct dirent *ep;
+    while ((ep = readdir(dp))) {
+        if (ep->d_type != DT_REG && ep->d_type != DT_LNK)
+            continue;
+
+        if (!DString::endWith(ep->d_name, ".desktop"))
+            continue;
+
+        data.names.push_back(ep->d_name);
+    }
+    closedir(dp);
+    std::sort(data.names.begin(), data.names.end());
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    // 目录中已删除的文件不再写回缓存
+    std::vector<std::string> oldNames;
+    auto iter = m_dirs.find(dirPath);
+    if (iter != m_dirs.end())
+        oldNames = iter->second.names;
+    else if (const DirRecord *record = findDirRecord(dirPath))
+        oldNames = recordNames(record);
+
+    for (const auto &name : oldNames) {
+        if (std::binary_search(data.names.begin(), data.names.end(), name))
+            continue;
+
+        std::string path = childPath(dirPath, name);
+        m_files.erase(path);
+        m_removed.insert(path);
+    }
+
+    m_dirs[dirPath] = data;
+    markDirty();
+
+    return data.names;
+}
+
+void DesktopEntryCache::setChangedCallback(std::function<void()> callback)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_changed = std::move(callback);
+}
+
+void DesktopEntryCache::markDirty()
+{
+    m_dirty = true;
+    if (m_changed)
+        m_changed();
+}
+
+bool DesktopEntryCache::save()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_dirty || m_cacheFile.empty())
+        return true;
+
+    PoolWriter pool;
+    std::vector<FileRecord> files;
+    std::vector<DirRecord> dirs;
+    std::vector<StrRef> sections;
+    std::vector<EntryRecord> entries;
+    std::vector<StrRef> names;
+
+    auto addFile = [&](std::string_view path, const FileStat &st, uint32_t flags,
+                       const std::vector<std::string_view> &fileSections,
+                       const std::vector<KeyFile::MappedEntry> &fileEntries) {
+        FileRecord record;
+        memset(&record, 0, sizeof(record));
+        record.path = pool.add<StrRef>(path);
+        record.ino = st.ino;
+        record.mtimeSec = st.mtimeSec;
+        record.mtimeNsec = st.mtimeNsec;
+        record.size = st.size;
+        record.flags = flags;
+        record.firstSection = uint32_t(sections.size());
+        record.sectionCount = uint32_t(fileSections.size());
+        record.firstEntry = uint32_t(entries.size());
+        record.entryCount = uint32_t(fileEntries.size());
+        for (const auto &section : fileSections)
+            sections.push_back(pool.add<StrRef>(section));
+
+        for (const auto &entry : fileEntries)
+            entries.push_back({pool.add<StrRef>(entry.section), pool.add<StrRef>(entry.key), pool.add<StrRef>(entry.value)});
+
+        files.push_back(record);
+    };
+
+    // 缓存中的旧记录与本次运行的新数据按路径归并，结果仍然有序
+    uint32_t recordIndex = 0;
+    auto iter = m_files.begin();
+    while (recordIndex < m_fileCount || iter != m_files.end()) {
+        const FileRecord *record = recordIndex < m_fileCount ? &m_fileRecords[recordIndex] : nullptr;
+        std::string_view recordPath = record ? str(record->path) : std::string_view();
+        if (record && (iter == m_files.end() || recordPath < iter->first)) {
+            recordIndex++;
+            if (m_removed.count(std::string(recordPath)))
+                continue;
+
+            KeyFile keyFile;
+            fillKeyFile(record, keyFile);
+            FileStat st = recordStat(record);
+            addFile(recordPath, st, record->flags & FlagParsed, keyFile.mappedSections(), keyFile.mappedEntries());
+            continue;
+        }
+
+        if (record && recordPath == iter->first)
+            recordIndex++;
+
+        const FileData &data = iter->second;
+        if (data.parsed)
+            addFile(iter->first, data.stat, FlagParsed, data.keyFile.mappedSections(), data.keyFile.mappedEntries());
+        else
+            addFile(iter->first, data.stat, 0, {}, {});
+
+        ++iter;
+    }
+
+    auto addDir = [&](std::string_view path, const FileStat &st, const auto &dirNames) {
+        DirRecord record;
+        memset(&record, 0, sizeof(record));
+        record.path = pool.add<StrRef>(path);
+        record.ino = st.ino;
+        record.mtimeSec = st.mtimeSec;
+        record.mtimeNsec = st.mtimeNsec;
+        record.size = st.size;
+        record.firstName = uint32_t(names.size());
+        record.nameCount = uint32_t(dirNames.size());
+        for (const auto &name : dirNames)
+            names.push_back(pool.add<StrRef>(name));
+
+        dirs.push_back(record);
+    };
+
+    recordIndex = 0;
+    auto dirIter = m_dirs.begin();
+    while (recordIndex < m_dirCount || dirIter != m_dirs.end()) {
+        const DirRecord *record = recordIndex < m_dirCount ? &m_dirRecords[recordIndex] : nullptr;
+        std::string_view recordPath = record ? str(record->path) : std::string_view();
+        if (record && (dirIter == m_dirs.end() || recordPath < dirIter->first)) {
+            recordIndex++;
+            FileStat st = recordStat(record);
+            std::vector<std::string_view> recordNames;
+            for (uint32_t i = 0; i < record->nameCount; i++)
+                recordNames.push_back(str(m_nameRefs[record->firstName + i]));
+
+            addDir(recordPath, st, recordNames);
+            continue;
+        }
+
+        if (record && recordPath == dirIter->first)
+            recordIndex++;
+
+        addDir(dirIter->first, dirIter->second.stat, dirIter->second.names);
+        ++dirIter;
+    }
+
+    Header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CacheMagic, sizeof(CacheMagic));
+    header.version = CacheVersion;
+    header.fileCount = uint32_t(files.size());
+    header.dirCount = uint32_t(dirs.size());
+    header.sectionCount = uint32_t(sections.size());
+    header.entryCount = uint32_t(entries.size());
+    header.nameCount = uint32_t(names.size());
+    header.poolSize = pool.data().size();
+
+    if (!makeDirs(m_cacheFile.substr(0, m_cacheFile.rfind('/'))))
+        return false;
+
+    // 先写临时文件再重命名，其他进程不会读到写了一半的缓存
+    std::string tmpFile = m_cacheFile + ".tmp." + std::to_string(getpid());
+    FILE *file = fopen(tmpFile.c_str(), "w");
+    if (!file) {
+        perror("open cache file failed: ");
+        return false;
+    }
+
+    bool ret = fwrite(&header, sizeof(header), 1, file) == 1
+               && writeArray(file, files)
+               && writeArray(file, dirs)
+               && writeArray(file, sections)
+               && writeArray(file, entries)
+               && writeArray(file, names)
+               && fwrite(pool.data().data(), 1, pool.data().size(), file) == pool.data().size();
+
+    if (fclose(file) != 0 || !ret || rename(tmpFile.c_str(), m_cacheFile.c_str()) < 0) {
+        std::cout << "failed to save desktop entry cache " << m_cacheFile << std::endl;
+        unlink(tmpFile.c_str());
+        return false;
+    }
+
+    // 新数据已全部写入缓存文件，重新映射后释放本次解析时保留的数据
+    m_files.clear();
+    m_dirs.clear();
+    m_removed.clear();
+    m_dirty = false;
+    loadCache();
+
+    return true;
+}
+
+void DesktopEntryCache::loadCache()
+{
+    m_mapping.reset();
+    m_fileRecords = nullptr;
+    m_fileCount = 0;
+    m_dirRecords = nullptr;
+    m_dirCount = 0;
+    m_sectionRefs = nullptr;
+    m_entryRecords = nullptr;
+    m_nameRefs = nullptr;
+    m_pool = nullptr;
+
+    if (m_cacheFile.empty())
+        return;
+
+    int fd = open(m_cacheFile.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return;
+
+    struct stat st;
+    if (fstat(fd, &st) < 0 || size_t(st.st_size) < sizeof(Header)) {
+        close(fd);
+        return;
+    }
+
+    size_t size = size_t(st.st_size);
+    void *addr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED)
+        return;
+
+    std::shared_ptr<const char> mapping(static_cast<const char *>(addr), [size](const char *p) {
+        munmap(const_cast<char *>(p), size);
+    });
+
+    const Header *header = reinterpret_cast<const Header *>(mapping.get());
+    if (memcmp(header->magic, CacheMagic, sizeof(CacheMagic)) != 0 || header->version != CacheVersion)
+        return;
+
+    uint64_t expected = sizeof(Header)
+                        + uint64_t(header->fileCount) * sizeof(FileRecord)
+                        + uint64_t(header->dirCount) * sizeof(DirRecord)
+                        + uint64_t(header->sectionCount) * sizeof(StrRef)
+                        + uint64_t(header->entryCount) * sizeof(EntryRecord)
+                        + uint64_t(header->nameCount) * sizeof(StrRef)
+                        + header->poolSize;
+    if (expected != size)
+        return;
+
+    const char *data = mapping.get() + sizeof(Header);
+    auto fileRecords = reinterpret_cast<const FileRecord *>(data);
+    data += header->fileCount * sizeof(FileRecord);
+    auto dirRecords = reinterpret_cast<const DirRecord *>(data);
+    data += header->dirCount * sizeof(DirRecord);
+    auto sectionRefs = reinterpret_cast<const StrRef *>(data);
+    data += header->sectionCount * sizeof(StrRef);
+    auto entryRecords = reinterpret_cast<const EntryRecord *>(data);
+    data += header->entryCount * sizeof(EntryRecord);
+    auto nameRefs = reinterpret_cast<const StrRef *>(data);
+    data += header->nameCount * sizeof(StrRef);
+
+    // 缓存文件可能被截断或损坏，使用前检查所有引用都在范围内
+    auto refOk = [header](const StrRef &ref) {
+        return uint64_t(ref.offset) + ref.length <= header->poolSize;
+    };
+    auto rangeOk = [](uint32_t first, uint32_t count, uint32_t total) {
+        return uint64_t(first) + count <= total;
+    };
+
+    for (uint32_t i = 0; i < header->fileCount; i++) {
+        const FileRecord &record = fileRecords[i];
+        if (!refOk(record.path)
+                || !rangeOk(record.firstSection, record.sectionCount, header->sectionCount)
+                || !rangeOk(record.firstEntry, record.entryCount, header->entryCount))
+            return;
+    }
+
+    for (uint32_t i = 0; i < header->dirCount; i++) {
+        if (!refOk(dirRecords[i].path) || !rangeOk(dirRecords[i].firstName, dirRecords[i].nameCount, header->nameCount))
+            return;
+    }
+
+    for (uint32_t i = 0; i < header->sectionCount; i++) {
+        if (!refOk(sectionRefs[i]))
+            return;
+    }
+
+    for (uint32_t i = 0; i < header->entryCount; i++) {
+        if (!refOk(entryRecords[i].section) || !refOk(entryRecords[i].key) || !refOk(entryRecords[i].value))
+            return;
+    }
+
+    for (uint32_t i = 0; i < header->nameCount; i++) {
+        if (!refOk(nameRefs[i]))
+            return;
+    }
+
+    m_mapping = mapping;
+    m_fileRecords = fileRecords;
+    m_fileCount = header->fileCount;
+    m_dirRecords = dirRecords;
+    m_dirCount = header->dirCount;
+    m_sectionRefs = sectionRefs;
+    m_entryRecords = entryRecords;
+    m_nameRefs = nameRefs;
+    m_pool = data;
+}
+
+bool DesktopEntryCache::statPath(const std::string &path, FileStat &st)
+{
+    struct stat buf;
+    if (stat(path.c_str(), &buf) < 0)
+        return false;
+
+    st.ino = buf.st_ino;
+    st.mtimeSec = buf.st_mtim.tv_sec;
+    st.mtimeNsec = buf.st_mtim.tv_nsec;
+    st.size = buf.st_size;
+    return true;
+}
+
+const DesktopEntryCache::FileRecord *DesktopEntryCache::findFileRecord(const std::string &path) const
+{
+    auto end = m_fileRecords + m_fileCount;
+    auto iter = std::lower_bound(m_fileRecords, end, std::string_view(path),
+                                 [this](const FileRecord &record, std::string_view target) {
+                                     return str(record.path) < target;
+                                 });
+    if (iter == end || str(iter->path) != path)
+        return nullptr;
+
+    return iter;
+}
+
+const DesktopEntryCache::DirRecord *DesktopEntryCache::findDirRecord(const std::string &path) const
+{
+    auto end = m_dirRecords + m_dirCount;
+    auto iter = std::lower_bound(m_dirRecords, end, std::string_view(path),
+                                 [this](const DirRecord &record, std::string_view target) {
+                                     return str(record.path) < target;
+                                 });
+    if (iter == end || str(iter->path) != path)
+        return nullptr;
+
+    return iter;
+}
+
+void DesktopEntryCache::fillKeyFile(const FileRecord *record, KeyFile &keyFile) const
+{
+    std::vector<std::string_view> sections;
+    sections.reserve(record->sectionCount);
+    for (uint32_t i = 0; i < record->sectionCount; i++)
+        sections.push_back(str(m_sectionRefs[record->firstSection + i]));
+
+    std::vector<KeyFile::MappedEntry> entries;
+    entries.reserve(record->entryCount);
+    for (uint32_t i = 0; i < record->entryCount; i++) {
+        const EntryRecord &entry = m_entryRecords[record->firstEntry + i];
+        entries.push_back({str(entry.section), str(entry.key), str(entry.value)});
+    }
+
+    keyFile.mapEntries(m_mapping, std::move(sections), std::move(entries), std::string(str(record->path)));
+}
+
+std::vector<std::string> DesktopEntryCache::recordNames(const DirRecord *record) const
+{
+    std::vector<std::string> names;
+    names.reserve(record->nameCount);
+    for (uint32_t i = 0; i < record->nameCount; i++)
+        names.emplace_back(str(m_nameRefs[record->firstName + i]));
+
+    return names;
+}
+
+std::string_view DesktopEntryCache::str(const StrRef &ref) const
+{
+    return std::string_view(m_pool + ref.offset, ref.length);
+}
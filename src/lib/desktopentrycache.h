@@ -0,0 +1,111 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef DESKTOPENTRYCACHE_H
+#define DESKTOPENTRYCACHE_H
+
+#include "keyfile.h"
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+/**
+ * @brief The DesktopEntryCache class desktop文件解析结果的磁盘缓存
+ * 缓存文件位于$XDG_CACHE_HOME/deepin/dde-application-manager/desktop-entry.cache，
+ * 以mmap方式加载，命中时KeyFile直接引用缓存中的字符串，不再打开desktop文件。
+ * 文件条目按inode、mtime和大小校验，目录列表按目录mtime校验。
+ * TryExec/Exec的检查结果不缓存，可执行文件可能在desktop文件之后才安装。
+ */
+class DesktopEntryCache
+{
+public:
+    static DesktopEntryCache *instance();
+
+    // 加载desktop文件，缓存失效时解析文件并记录新的结果
+    bool loadFile(const std::string &filePath, KeyFile &keyFile);
+    // 目录下的.desktop文件名(普通文件或链接)，按名称排序
+    std::vector<std::string> listDir(const std::string &dirPath);
+
+    // 有新数据时写回磁盘，写入后释放本次解析时保留的数据
+    bool save();
+    // 每次产生新数据时调用，用于安排稍后写回；调用时持有内部锁，可能在任意线程，只应投递事件
+    void setChangedCallback(std::function<void()> callback);
+
+    std::string cacheFile() const
+    {
+        return m_cacheFile;
+    }
+
+private:
+    struct FileStat {
+        FileStat() : ino(0), mtimeSec(0), mtimeNsec(0), size(0) {}
+        uint64_t ino;
+        int64_t mtimeSec;
+        int64_t mtimeNsec;
+        int64_t size;
+        bool operator==(const FileStat &other) const;
+    };
+
+    // 本次运行中新解析或更新过的文件
+    struct FileData {
+        FileData() : parsed(false) {}
+        FileStat stat;
+        bool parsed;
+        KeyFile keyFile;
+    };
+
+    struct DirData {
+        FileStat stat;
+        std::vector<std::string> names;
+    };
+
+    // 磁盘格式，定义见desktopentrycache.cpp
+    struct StrRef;
+    struct EntryRecord;
+    struct FileRecord;
+    struct DirRecord;
+
+    DesktopEntryCache();
+    DesktopEntryCache(const DesktopEntryCache &);
+    DesktopEntryCache& operator= (const DesktopEntryCache &);
+
+    void loadCache();
+    void markDirty(); // 须持有m_mutex
+    static bool statPath(const std::string &path, FileStat &st);
+    template<typename Record>
+    static FileStat recordStat(const Record *record);
+
+    // 以下函数调用前须持有m_mutex
+    const FileRecord *findFileRecord(const std::string &path) const;
+    const DirRecord *findDirRecord(const std::string &path) const;
+    void fillKeyFile(const FileRecord *record, KeyFile &keyFile) const;
+    std::vector<std::string> recordNames(const DirRecord *record) const;
+    std::string_view str(const StrRef &ref) const;
+
+    std::string m_cacheFile;
+
+    std::mutex m_mutex;
+    std::shared_ptr<const char> m_mapping; // 缓存文件的映射，KeyFile引用其中的字符串
+    const FileRecord *m_fileRecords;
+    uint32_t m_fileCount;
+    const DirRecord *m_dirRecords;
+    uint32_t m_dirCount;
+    const StrRef *m_sectionRefs;
+    const EntryRecord *m_entryRecords;
+    const StrRef *m_nameRefs;
+    const char *m_pool;
+
+    std::map<std::string, FileData> m_files;
+    std::map<std::string, DirData> m_dirs;
+    std::set<std::string> m_removed;
+    bool m_dirty;
+    std::function<void()> m_changed;
+};
+
+#endif // DESKTOPENTRYCACHE_H
@@ -12,6 +12,8 @@ DesktopFile::DesktopFile(char separtor)
 DesktopFile::~DesktopFile() = default;
 
 bool DesktopFile::saveToFile(const std::string &filePath){
+    detach();
+
     FILE *sfp = fopen(filePath.data(), "w+");
     if (!sfp) {
         perror("open file failed...");
@@ -4,22 +4,26 @@
 
 #include "desktopinfo.h"
 #include "locale.h"
+#include "dlocale.h"
 #include "unistd.h"
 #include "dstring.h"
 #include "dfile.h"
 #include "basedir.h"
+#include "desktopentrycache.h"
+#include "executableindex.h"
 
 #include <QDebug>
 
 #include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
 #include <stdlib.h>
 #include <iostream>
-#include <dirent.h>
-
-std::vector<std::string> DesktopInfo::currentDesktops;
 
 DesktopInfo::DesktopInfo(const std::string &_fileName)
     : m_isValid(true)
+    , m_executable(-1)
     , m_desktopFile()
 {
     std::string fileNameWithSuffix(_fileName);
@@ -45,7 +49,7 @@ DesktopInfo::DesktopInfo(const std::string &_fileName)
         }
     }
 
-    m_desktopFile.loadFile(m_fileName);
+    DesktopEntryCache::instance()->loadFile(m_fileName, m_desktopFile);
 
     // check DesktopInfo valid
     std::vector<std::string> mainKeys = m_desktopFile.getMainKeys();
@@ -61,7 +65,6 @@ DesktopInfo::DesktopInfo(const std::string &_fileName)
     if (m_desktopFile.getStr(MainSection, KeyType) != TypeApplication)
         m_isValid = false;
 
-    m_name = m_desktopFile.getLocaleStr(MainSection, KeyName, "");
     m_icon = m_desktopFile.getStr(MainSection, KeyIcon);
     m_id = getId();
 }
@@ -112,11 +115,10 @@ bool DesktopInfo::getShowIn(std::vector<std::string> desktopEnvs)
     qDebug() << "desktop file path: " << QString::fromStdString(m_fileName);
 #endif
 
+    // 扫描时会在多个线程中调用，这里不能修改共享的状态
     if (desktopEnvs.size() == 0) {
         const char *env = getenv(envDesktopEnv.c_str());
-        const auto &desktop = DString::splitChars(env, ':');
-        currentDesktops.assign(desktop.begin(), desktop.end());
-        desktopEnvs.assign(currentDesktops.begin(), currentDesktops.end());
+        desktopEnvs = DString::splitChars(env, ':');
     }
 
     std::vector<std::string> onlyShowIn = m_desktopFile.getStrList(MainSection, KeyOnlyShowIn);
@@ -163,6 +165,17 @@ std::string DesktopInfo::getExecutable()
 }
 
 bool DesktopInfo::isExecutableOk()
+{
+    if (m_executable >= 0)
+        return m_executable > 0;
+
+    // 不使用磁盘缓存: 绝对路径只需一次stat，$PATH中的查找由ExecutableIndex处理目录变化
+    const bool ok = checkExecutable();
+    m_executable = ok ? 1 : 0;
+    return ok;
+}
+
+bool DesktopInfo::checkExecutable()
 {
     // 检查TryExec字段
     std::string value = getTryExec();
@@ -212,19 +225,7 @@ bool DesktopInfo::isDesktopAction(std::string name)
 
 std::vector<DesktopAction> DesktopInfo::getActions()
 {
-    std::vector<DesktopAction> actions;
-    for (const auto &mainKey : m_desktopFile.getMainKeys()) {
-        if (DString::startWith(mainKey, "Desktop Action")
-                || DString::endWith(mainKey, "Shortcut Group")) {
-            DesktopAction action;
-            action.name = m_desktopFile.getLocaleStr(mainKey, KeyName, "");
-            action.exec = m_desktopFile.getStr(mainKey, KeyExec);
-            action.section = mainKey;
-            actions.push_back(action);
-        }
-    }
-
-    return actions;
+    return localeStrings().actions;
 }
 
 // 使用appId获取DesktopInfo需检查有效性
@@ -258,9 +259,7 @@ std::string DesktopInfo::getTryExec()
 // 按$PATH路径查找执行文件
 bool DesktopInfo::findExecutable(std::string &exec)
 {
-    static const char *path = getenv("PATH");
-    static std::vector<std::string> paths = DString::splitChars(path, ':');
-    return std::any_of(paths.begin(), paths.end(), [&exec](std::string path) {return DFile::isExisted(path + "/" +exec);});
+    return ExecutableIndex::instance()->contains(exec);
 }
 
 /**
@@ -301,12 +300,17 @@ std::string DesktopInfo::getId()
 
 std::string DesktopInfo::getGenericName()
 {
-    return m_desktopFile.getLocaleStr(MainSection, KeyGenericName, "");
+    return localeStrings().genericName;
 }
 
 std::string DesktopInfo::getName()
 {
-    return m_name;
+    return localeStrings().name;
+}
+
+std::string DesktopInfo::getComment()
+{
+    return localeStrings().comment;
 }
 
 std::string DesktopInfo::getIcon()
@@ -321,7 +325,7 @@ std::string DesktopInfo::getCommandLine()
 
 std::vector<std::string> DesktopInfo::getKeywords()
 {
-    return m_desktopFile.getLocaleStrList(MainSection, KeyKeywords, "");
+    return localeStrings().keywords;
 }
 
 std::vector<std::string> DesktopInfo::getCategories()
@@ -339,6 +343,63 @@ DesktopFile *DesktopInfo::getDesktopFile()
     return &m_desktopFile;
 }
 
+const DesktopInfo::LocaleStrings &DesktopInfo::localeStrings()
+{
+    if (m_localeStrings)
+        return *m_localeStrings;
+
+    auto strings = std::make_shared<LocaleStrings>();
+    strings->name = m_desktopFile.getLocaleStr(MainSection, KeyName, "");
+    strings->genericName = m_desktopFile.getLocaleStr(MainSection, KeyGenericName, "");
+    strings->comment = m_desktopFile.getLocaleStr(MainSection, KeyComment, "");
+    strings->keywords = m_desktopFile.getLocaleStrList(MainSection, KeyKeywords, "");
+    for (const auto &mainKey : m_desktopFile.getMainKeys()) {
+        if (DString::startWith(mainKey, "Desktop Action")
+                || DString::endWith(mainKey, "Shortcut Group")) {
+            DesktopAction action;
+            action.name = m_desktopFile.getLocaleStr(mainKey, KeyName, "");
+            action.exec = m_desktopFile.getStr(mainKey, KeyExec);
+            action.section = mainKey;
+            strings->actions.push_back(action);
+        }
+    }
+
+    m_localeStrings = strings;
+    return *m_localeStrings;
+}
+
+namespace {
+
+const unsigned int MaxScanWorkers = 8;
+
+// 将[0, count)分给最多workers个线程处理，workers为1时在当前线程中串行执行
+template<typename Func>
+void parallelFor(size_t count, unsigned int workers, Func func)
+{
+    if (workers <= 1 || count <= 1) {
+        for (size_t i = 0; i < count; i++)
+            func(i);
+
+        return;
+    }
+
+    std::atomic<size_t> next(0);
+    auto run = [&next, count, &func] {
+        for (size_t i = next++; i < count; i = next++)
+            func(i);
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < std::min<size_t>(workers, count); i++)
+        threads.emplace_back(run);
+
+    run();
+    for (auto &thread : threads)
+        thread.join();
+}
+
+} // namespace
+
 // class AppsDir
 AppsDir::AppsDir(const std::string &dirPath)
     : m_path(dirPath)
@@ -360,51 +421,49 @@ std::string AppsDir::getPath()
 // 获取目录对应的应用名称
 std::map<std::string, bool> AppsDir::getAppNames()
 {
-    DIR* dp;
-    struct dirent* ep;
-
-    dp = opendir(m_path.c_str());
-    if (!dp) {
-        std::cout << "Couldn't open directory " << m_path << std::endl;
-        return m_appNames;
-    }
-
-    while ((ep = readdir(dp))) {
-        if (ep->d_type != DT_REG && ep->d_type != DT_LNK)
-            continue;
-
-        if (!DString::endWith(ep->d_name, ".desktop"))
-            continue;
-
-        m_appNames.insert({ep->d_name, true});
-    }
-    closedir(dp);
+    for (const auto &name : DesktopEntryCache::instance()->listDir(m_path))
+        m_appNames.insert({name, true});
 
     return m_appNames;
 }
 
 // 获取所有应用信息
-std::vector<DesktopInfo> AppsDir::getAllDesktopInfos()
+std::vector<DesktopInfo> AppsDir::getAllDesktopInfos(unsigned int maxWorkers)
 {
-    std::vector<DesktopInfo> desktopInfos;
-
-    for (auto dir : BaseDir::appDirs()) {
-        AppsDir appsDir(dir);
-        std::map<std::string, bool> appNames = appsDir.getAppNames();
-        if (appNames.size() == 0)
-            continue;
+    if (maxWorkers == 0)
+        maxWorkers = std::min(std::max(std::thread::hardware_concurrency(), 1u), MaxScanWorkers);
+
+    // 各目录的文件列表，目录顺序即XDG优先级
+    std::vector<std::string> dirs = BaseDir::appDirs();
+    std::vector<std::vector<std::string>> dirFiles(dirs.size());
+    parallelFor(dirs.size(), maxWorkers, [&dirs, &dirFiles](size_t index) {
+        AppsDir appsDir(dirs[index]);
+        for (const auto &iter : appsDir.getAppNames())
+            dirFiles[index].push_back(dirs[index] + iter.first);
+    });
+
+    std::vector<std::string> filePaths;
+    for (auto &files : dirFiles)
+        filePaths.insert(filePaths.end(), files.begin(), files.end());
+
+    // 解析及可执行检查并行完成，结果按下标存放，合并后与串行扫描的顺序一致
+    std::vector<std::unique_ptr<DesktopInfo>> results(filePaths.size());
+    parallelFor(filePaths.size(), maxWorkers, [&filePaths, &results](size_t index) {
+        const std::string &filePath = filePaths[index];
+        std::unique_ptr<DesktopInfo> desktopInfo(new DesktopInfo(filePath));
+        if (!desktopInfo->isValidDesktop() || !desktopInfo->shouldShow()) {
+            qDebug() << QString("app item %1 doesn't show in the list..").arg(QString::fromStdString(filePath));
+            return;
+        }
 
-        for (const auto &iter : appNames) {
-            std::string filePath =  dir + iter.first;
+        desktopInfo->isExecutableOk();
+        results[index] = std::move(desktopInfo);
+    });
 
-            DesktopInfo desktopInfo(filePath);
-            if (!DFile::isExisted(filePath) || !desktopInfo.isValidDesktop() || !desktopInfo.shouldShow()) {
-                qDebug() << QString("app item %1 doesn't show in the list..").arg(QString::fromStdString(filePath));
-                continue;
-            }
-
-            desktopInfos.push_back(desktopInfo);
-        }
+    std::vector<DesktopInfo> desktopInfos;
+    for (auto &desktopInfo : results) {
+        if (desktopInfo)
+            desktopInfos.push_back(std::move(*desktopInfo));
     }
 
     return desktopInfos;
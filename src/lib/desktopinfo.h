@@ -7,6 +7,7 @@
 
 #include "desktopfile.h"
 
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -76,6 +77,7 @@ public:
     std::string getId();
     std::string getGenericName();
     std::string getName();
+    std::string getComment();
     std::string getIcon();
     std::string getCommandLine();
     std::vector<std::string> getKeywords();
@@ -85,18 +87,28 @@ public:
     DesktopFile *getDesktopFile();
 
 private:
+    // 按进程语言解析好的本地化字段，首次使用时生成
+    struct LocaleStrings {
+        std::string name;
+        std::string genericName;
+        std::string comment;
+        std::vector<std::string> keywords;
+        std::vector<DesktopAction> actions;
+    };
+
+    const LocaleStrings &localeStrings();
     std::string getTryExec();
+    bool checkExecutable();
     bool findExecutable(std::string &exec);
 
-    static std::vector<std::string> currentDesktops;
-
     std::string m_fileName;
     std::string m_id;
-    std::string m_name;
     std::string m_icon;
     std::string m_overRideExec;
     bool m_isValid;
+    int m_executable; // isExecutableOk的结果，-1表示尚未检查
     DesktopFile m_desktopFile;
+    std::shared_ptr<const LocaleStrings> m_localeStrings;
 };
 
 // 应用目录类
@@ -107,7 +119,8 @@ public:
 
     std::string getPath();
     std::map<std::string, bool> getAppNames();
-    static std::vector<DesktopInfo> getAllDesktopInfos();
+    // maxWorkers为0时按CPU核数并行扫描，为1时串行扫描
+    static std::vector<DesktopInfo> getAllDesktopInfos(unsigned int maxWorkers = 0);
 
 private:
     std::string m_path;
@@ -6,7 +6,6 @@
 #include "dstring.h"
 
 #include <stdlib.h>
-#include <pthread.h>
 
 #define ComponentCodeset 1
 #define ComponentTerritory 2
@@ -21,8 +20,6 @@ const char charAt = '@';
 
 Locale::Locale()
 {
-    pthread_mutex_init(&m_languageNames.mutex, nullptr);
-
     // init aliases
     FILE *fp = fopen(aliasFile, "r");
     if (fp) {
@@ -168,26 +165,28 @@ std::vector<std::string> Locale::getLocaleVariants(const std::string &locale)
 
 std::vector<std::string> Locale::getLanguageNames()
 {
-    std::vector<std::string> names;
-    std::string value(guessCategoryValue("LC_MESSAGES"));
-    if (value.empty()) {
-        names.push_back(value);
-        return names;
-    }
+    return *getSharedLanguageNames();
+}
 
-    pthread_mutex_lock(&m_languageNames.mutex);
-    if (m_languageNames.language != value) {
-        m_languageNames.language = value;
-        m_languageNames.names.clear();
-        std::vector<std::string> langs = DString::splitStr(value, ':');
-        for (const auto & lang : langs) {
-            std::vector<std::string> localeVariant = getLocaleVariants(unaliasLang(lang));
-            for (const auto & var : localeVariant)
-                m_languageNames.names.push_back(var);
+std::shared_ptr<const std::vector<std::string>> Locale::getSharedLanguageNames()
+{
+    std::call_once(m_languageNamesOnce, [this] {
+        std::string value(guessCategoryValue("LC_MESSAGES"));
+        auto names = std::make_shared<std::vector<std::string>>();
+        if (value.empty()) {
+            names->push_back(value);
+        } else {
+            std::vector<std::string> langs = DString::splitStr(value, ':');
+            for (const auto & lang : langs) {
+                std::vector<std::string> localeVariant = getLocaleVariants(unaliasLang(lang));
+                for (const auto & var : localeVariant)
+                    names->push_back(var);
+            }
+            names->push_back("C");
         }
-        m_languageNames.names.push_back("C");
-    }
-    pthread_mutex_unlock(&m_languageNames.mutex);
 
-    return m_languageNames.names;
+        m_languageNames = names;
+    });
+
+    return m_languageNames;
 }
@@ -8,15 +8,11 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <memory>
+#include <mutex>
 
 // 本地化类
 class Locale {
-    struct LanguageNameCache {
-        std::string language;
-        std::vector<std::string> names;
-        pthread_mutex_t mutex;
-    };
-
     struct Components {
         Components() : mask(0) {}   // 数字必须初始化
         std::string language;
@@ -29,6 +25,8 @@ class Locale {
 public:
     std::vector<std::string> getLocaleVariants(const std::string &locale);
     std::vector<std::string> getLanguageNames();
+    // 不拷贝的版本，语言取自进程环境，运行期间不变，首次调用时解析，之后返回同一份列表
+    std::shared_ptr<const std::vector<std::string>> getSharedLanguageNames();
     static inline Locale *instance() {
         static Locale instance;
         return &instance;
@@ -43,7 +41,8 @@ private:
     std::string guessCategoryValue(std::string categoryName);
     std::string unaliasLang(std::string);
     std::map<std::string, std::string> m_aliases;
-    LanguageNameCache m_languageNames;
+    std::shared_ptr<const std::vector<std::string>> m_languageNames;
+    std::once_flag m_languageNamesOnce;
 };
 
 #endif
@@ -0,0 +1,309 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "elfdeps.h"
+#include "dstring.h"
+
+#include <elf.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <glob.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <deque>
+#include <fstream>
+#include <set>
+
+namespace {
+
+struct ElfFile {
+    ElfFile() : elfClass(0), machine(0) {}
+
+    unsigned char elfClass;
+    uint16_t machine;
+    std::vector<std::string> needed;
+    std::string rpath;
+    std::string runpath;
+};
+
+// 动态段和字符串表的大小上限，超过时视为无效文件
+const uint64_t MaxTableSize = 4 * 1024 * 1024;
+
+// 从offset处读取len字节，文件被截断时返回false
+bool readAt(int fd, void *buf, size_t len, uint64_t offset)
+{
+    char *p = static_cast<char *>(buf);
+    while (len > 0) {
+        const ssize_t n = pread(fd, p, len, off_t(offset));
+        if (n < 0 && errno == EINTR)
+            continue;
+
+        if (n <= 0)
+            return false;
+
+        p += n;
+        len -= size_t(n);
+        offset += uint64_t(n);
+    }
+
+    return true;
+}
+
+template<typename Ehdr, typename Phdr, typename Dyn>
+bool parseDynamic(int fd, uint64_t size, ElfFile &elf)
+{
+    Ehdr ehdr;
+    if (size < sizeof(Ehdr) || !readAt(fd, &ehdr, sizeof(ehdr), 0)
+            || ehdr.e_phentsize != sizeof(Phdr)
+            || ehdr.e_phoff > size || ehdr.e_phnum > (size - ehdr.e_phoff) / sizeof(Phdr))
+        return false;
+
+    elf.machine = ehdr.e_machine;
+
+    std::vector<Phdr> phdrs(ehdr.e_phnum);
+    if (!phdrs.empty() && !readAt(fd, phdrs.data(), phdrs.size() * sizeof(Phdr), ehdr.e_phoff))
+        return false;
+
+    const Phdr *dynamic = nullptr;
+    for (const Phdr &phdr : phdrs) {
+        if (phdr.p_type == PT_DYNAMIC)
+            dynamic = &phdr;
+    }
+
+    // 静态链接，没有依赖
+    if (!dynamic)
+        return true;
+
+    if (dynamic->p_offset > size || dynamic->p_filesz > size - dynamic->p_offset || dynamic->p_filesz > MaxTableSize)
+        return false;
+
+    std::vector<Dyn> dyns(dynamic->p_filesz / sizeof(Dyn));
+    if (!dyns.empty() && !readAt(fd, dyns.data(), dyns.size() * sizeof(Dyn), dynamic->p_offset))
+        return false;
+
+    uint64_t strtab = 0;
+    uint64_t strsz = 0;
+    for (size_t i = 0; i < dyns.size() && dyns[i].d_tag != DT_NULL; ++i) {
+        if (dyns[i].d_tag == DT_STRTAB)
+            strtab = dyns[i].d_un.d_ptr;
+        else if (dyns[i].d_tag == DT_STRSZ)
+            strsz = dyns[i].d_un.d_val;
+    }
+
+    // DT_STRTAB是虚拟地址，按PT_LOAD段换算为文件偏移
+    uint64_t strOffset = UINT64_MAX;
+    for (const Phdr &phdr : phdrs) {
+        if (phdr.p_type == PT_LOAD && strtab >= phdr.p_vaddr && strtab < phdr.p_vaddr + phdr.p_filesz) {
+            strOffset = strtab - phdr.p_vaddr + phdr.p_offset;
+            break;
+        }
+    }
+
+    if (strOffset > size || strsz > size - strOffset || strsz > MaxTableSize)
+        return false;
+
+    std::vector<char> strings(strsz);
+    if (strsz > 0 && !readAt(fd, strings.data(), strsz, strOffset))
+        return false;
+
+    auto str = [&strings](uint64_t index) {
+        return index < strings.size()
+                ? std::string(strings.data() + index, strnlen(strings.data() + index, strings.size() - index))
+                : std::string();
+    };
+
+    for (size_t i = 0; i < dyns.size() && dyns[i].d_tag != DT_NULL; ++i) {
+        switch (dyns[i].d_tag) {
+        case DT_NEEDED:
+            elf.needed.push_back(str(dyns[i].d_un.d_val));
+            break;
+        case DT_RPATH:
+            elf.rpath = str(dyns[i].d_un.d_val);
+            break;
+        case DT_RUNPATH:
+            elf.runpath = str(dyns[i].d_un.d_val);
+            break;
+        default:
+            break;
+        }
+    }
+
+    return true;
+}
+
+// 文件可能在读取时被替换或截断(如升级软件包)，使用pread而不是mmap，截断时只会读取失败
+bool loadElf(const std::string &path, ElfFile &elf)
+{
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    unsigned char ident[EI_NIDENT];
+    if (fstat(fd, &st) < 0 || !S_ISREG(st.st_mode) || size_t(st.st_size) < EI_NIDENT
+            || !readAt(fd, ident, sizeof(ident), 0)) {
+        close(fd);
+        return false;
+    }
+
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    const unsigned char nativeData = ELFDATA2LSB;
+#else
+    const unsigned char nativeData = ELFDATA2MSB;
+#endif
+
+    bool ok = false;
+    const uint64_t size = uint64_t(st.st_size);
+    if (!memcmp(ident, ELFMAG, SELFMAG) && ident[EI_DATA] == nativeData) {
+        elf.elfClass = ident[EI_CLASS];
+        if (elf.elfClass == ELFCLASS64)
+            ok = parseDynamic<Elf64_Ehdr, Elf64_Phdr, Elf64_Dyn>(fd, size, elf);
+        else if (elf.elfClass == ELFCLASS32)
+            ok = parseDynamic<Elf32_Ehdr, Elf32_Phdr, Elf32_Dyn>(fd, size, elf);
+    }
+
+    close(fd);
+    return ok;
+}
+
+// 拆分搜索路径并替换$ORIGIN
+std::vector<std::string> searchDirs(const std::string &paths, const std::string &origin)
+{
+    std::vector<std::string> dirs;
+    for (std::string dir : DString::splitStr(paths, ':')) {
+        for (const char *token : {"${ORIGIN}", "$ORIGIN"}) {
+            size_t pos;
+            while ((pos = dir.find(token)) != std::string::npos)
+                dir.replace(pos, strlen(token), origin);
+        }
+
+        if (!dir.empty())
+            dirs.push_back(dir);
+    }
+
+    return dirs;
+}
+
+std::string trim(const std::string &str)
+{
+    const size_t begin = str.find_first_not_of(" \t\r");
+    if (begin == std::string::npos)
+        return std::string();
+
+    return str.substr(begin, str.find_last_not_of(" \t\r") - begin + 1);
+}
+
+void readLdConf(const std::string &file, std::vector<std::string> &dirs, int depth)
+{
+    std::ifstream in(file);
+    std::string line;
+    while (depth < 4 && std::getline(in, line)) {
+        line = trim(line.substr(0, line.find('#')));
+        if (line.empty())
+            continue;
+
+        if (!DString::startWith(line, "include ")) {
+            dirs.push_back(line);
+            continue;
+        }
+
+        std::string pattern = trim(line.substr(8));
+        if (pattern.empty())
+            continue;
+
+        if (pattern[0] != '/')
+            pattern = file.substr(0, file.rfind('/') + 1) + pattern;
+
+        glob_t matches;
+        if (glob(pattern.c_str(), 0, nullptr, &matches) == 0) {
+            for (size_t i = 0; i < matches.gl_pathc; ++i)
+                readLdConf(matches.gl_pathv[i], dirs, depth + 1);
+        }
+        globfree(&matches);
+    }
+}
+
+} // namespace
+
+std::vector<std::string> ElfDeps::resolve(const std::string &executable, size_t maxFiles)
+{
+    std::vector<std::string> files;
+    if (maxFiles == 0)
+        return files;
+
+    files.push_back(executable);
+
+    ElfFile exe;
+    if (!loadElf(executable, exe))
+        return files;
+
+    const char *ldLibraryPath = getenv("LD_LIBRARY_PATH");
+    const std::vector<std::string> envDirs = ldLibraryPath ? searchDirs(ldLibraryPath, std::string()) : std::vector<std::string>();
+
+    std::set<std::string> seen {executable};
+    std::deque<std::pair<std::string, ElfFile>> queue;
+    queue.emplace_back(executable, exe);
+    while (!queue.empty() && files.size() < maxFiles) {
+        const std::string path = queue.front().first;
+        const ElfFile elf = queue.front().second;
+        queue.pop_front();
+
+        const std::string origin = path.substr(0, path.rfind('/'));
+        std::vector<std::string> dirs;
+        if (elf.runpath.empty()) {
+            for (const std::string &dir : searchDirs(elf.rpath, origin))
+                dirs.push_back(dir);
+        }
+        dirs.insert(dirs.end(), envDirs.begin(), envDirs.end());
+        for (const std::string &dir : searchDirs(elf.runpath, origin))
+            dirs.push_back(dir);
+        dirs.insert(dirs.end(), systemDirs().begin(), systemDirs().end());
+
+        for (const std::string &name : elf.needed) {
+            if (files.size() >= maxFiles)
+                break;
+
+            std::vector<std::string> candidates;
+            if (name.find('/') != std::string::npos) {
+                candidates.push_back(name);
+            } else {
+                for (const std::string &dir : dirs)
+                    candidates.push_back(dir + "/" + name);
+            }
+
+            for (const std::string &candidate : candidates) {
+                if (seen.count(candidate))
+                    break;
+
+                // 与可执行文件位数或架构不同的库被跳过，与ld.so一致
+                ElfFile lib;
+                if (!loadElf(candidate, lib) || lib.elfClass != exe.elfClass || lib.machine != exe.machine)
+                    continue;
+
+                seen.insert(candidate);
+                files.push_back(candidate);
+                queue.emplace_back(candidate, lib);
+                break;
+            }
+        }
+    }
+
+    return files;
+}
+
+const std::vector<std::string> &ElfDeps::systemDirs()
+{
+    static const std::vector<std::string> dirs = [] {
+        std::vector<std::string> dirs;
+        readLdConf("/etc/ld.so.conf", dirs, 0);
+        for (const char *dir : {"/lib64", "/usr/lib64", "/lib", "/usr/lib"})
+            dirs.push_back(dir);
+
+        return dirs;
+    }();
+
+    return dirs;
+}
@@ -0,0 +1,27 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef ELFDEPS_H
+#define ELFDEPS_H
+
+#include <string>
+#include <vector>
+
+/**
+ * @brief The ElfDeps class 解析ELF文件依赖的共享库
+ * 用pread只读取ELF头、程序头、动态段(DT_NEEDED、DT_RUNPATH/DT_RPATH)和字符串表，不映射文件。
+ * 查找顺序与ld.so相近：RPATH(没有RUNPATH时)、LD_LIBRARY_PATH、RUNPATH、
+ * /etc/ld.so.conf中的目录、系统默认目录，不解析ld.so.cache。
+ */
+class ElfDeps
+{
+public:
+    // 可执行文件及其递归依赖的全部共享库的路径，包括可执行文件本身，最多maxFiles个
+    static std::vector<std::string> resolve(const std::string &executable, size_t maxFiles);
+
+private:
+    static const std::vector<std::string> &systemDirs();
+};
+
+#endif // ELFDEPS_H
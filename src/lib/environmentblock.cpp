@@ -0,0 +1,137 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "environmentblock.h"
+
+#include <algorithm>
+#include <cstring>
+
+extern char **environ;
+
+namespace {
+
+// 启动使用代理的应用时需要去掉的变量
+const std::vector<std::string> ProxyKeys = {
+    "auto_proxy", "AUTO_PROXY",
+    "http_proxy", "HTTP_PROXY",
+    "https_proxy", "HTTPS_PROXY",
+    "ftp_proxy", "FTP_PROXY",
+    "SOCKS_SERVER",
+    "no_proxy", "NO_PROXY",
+};
+
+size_t keyLength(const char *entry)
+{
+    const char *eq = strchr(entry, '=');
+    return eq ? size_t(eq - entry) : strlen(entry);
+}
+
+// 按KEY比较，KEY相同返回0
+int compareKey(const char *a, size_t aLen, const char *b, size_t bLen)
+{
+    int ret = memcmp(a, b, std::min(aLen, bLen));
+    if (ret)
+        return ret;
+
+    return aLen < bLen ? -1 : (aLen > bLen ? 1 : 0);
+}
+
+} // namespace
+
+std::shared_ptr<const EnvironmentBlock> EnvironmentBlock::session()
+{
+    static std::shared_ptr<const EnvironmentBlock> block(new EnvironmentBlock(environ));
+    return block;
+}
+
+std::shared_ptr<const EnvironmentBlock> EnvironmentBlock::sessionWithoutProxy()
+{
+    static std::shared_ptr<const EnvironmentBlock> block(new EnvironmentBlock(environ, ProxyKeys));
+    return block;
+}
+
+EnvironmentBlock::EnvironmentBlock(const char *const *envp, const std::vector<std::string> &removeKeys)
+{
+    std::vector<const char *> entries;
+    size_t total = 0;
+    for (const char *const *env = envp; env && *env; ++env) {
+        const size_t len = keyLength(*env);
+        bool removed = std::any_of(removeKeys.begin(), removeKeys.end(), [&](const std::string &key) {
+            return key.size() == len && !memcmp(key.data(), *env, len);
+        });
+        if (removed)
+            continue;
+
+        entries.push_back(*env);
+        total += strlen(*env) + 1;
+    }
+
+    // 稳定排序后相同KEY中第一个在前
+    std::stable_sort(entries.begin(), entries.end(), [](const char *a, const char *b) {
+        return compareKey(a, keyLength(a), b, keyLength(b)) < 0;
+    });
+
+    m_storage.reset(new char[total ? total : 1]);
+    m_envp.reserve(entries.size() + 1);
+    char *pos = m_storage.get();
+    for (const char *entry : entries) {
+        if (!m_envp.empty() && !compareKey(m_envp.back(), keyLength(m_envp.back()), entry, keyLength(entry)))
+            continue;
+
+        const size_t len = strlen(entry) + 1;
+        memcpy(pos, entry, len);
+        m_envp.push_back(pos);
+        pos += len;
+    }
+    m_envp.push_back(nullptr);
+}
+
+const char *EnvironmentBlock::value(const std::string &key) const
+{
+    long index = find(key.data(), key.size());
+    if (index < 0)
+        return nullptr;
+
+    const char *entry = m_envp[size_t(index)];
+    return entry[key.size()] == '=' ? entry + key.size() + 1 : entry + key.size();
+}
+
+std::vector<char *> EnvironmentBlock::merge(const std::vector<std::string> &overlay) const
+{
+    // 被overlay替换的下标
+    std::vector<size_t> replaced;
+    replaced.reserve(overlay.size());
+    for (const std::string &entry : overlay) {
+        long index = find(entry.c_str(), keyLength(entry.c_str()));
+        if (index >= 0)
+            replaced.push_back(size_t(index));
+    }
+    std::sort(replaced.begin(), replaced.end());
+
+    std::vector<char *> ret;
+    ret.reserve(size() + overlay.size() + 1);
+    size_t begin = 0;
+    for (size_t index : replaced) {
+        ret.insert(ret.end(), m_envp.begin() + begin, m_envp.begin() + index);
+        begin = index + 1;
+    }
+    ret.insert(ret.end(), m_envp.begin() + std::min(begin, size()), m_envp.begin() + size());
+
+    for (const std::string &entry : overlay)
+        ret.push_back(const_cast<char *>(entry.c_str()));
+
+    ret.push_back(nullptr);
+    return ret;
+}
+
+long EnvironmentBlock::find(const char *key, size_t len) const
+{
+    auto iter = std::lower_bound(m_envp.begin(), m_envp.end() - 1, key, [len](const char *entry, const char *key) {
+        return compareKey(entry, keyLength(entry), key, len) < 0;
+    });
+    if (iter == m_envp.end() - 1 || compareKey(*iter, keyLength(*iter), key, len))
+        return -1;
+
+    return long(iter - m_envp.begin());
+}
@@ -0,0 +1,55 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef ENVIRONMENTBLOCK_H
+#define ENVIRONMENTBLOCK_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief The EnvironmentBlock class 不可变的环境变量块
+ * 所有KEY=VALUE保存在一块连续内存中，envp按KEY排序，可直接传给exec。
+ * 启动应用时只需在其上叠加少量变量(overlay)，不再逐个复制整个环境。
+ */
+class EnvironmentBlock
+{
+public:
+    // 守护进程的环境，第一次调用时生成快照(守护进程运行期间不修改自身环境)
+    static std::shared_ptr<const EnvironmentBlock> session();
+    // 去掉代理相关变量的会话环境
+    static std::shared_ptr<const EnvironmentBlock> sessionWithoutProxy();
+
+    // removeKeys中的变量不加入，重复的KEY保留第一个
+    explicit EnvironmentBlock(const char *const *envp, const std::vector<std::string> &removeKeys = {});
+
+    size_t size() const
+    {
+        return m_envp.size() - 1;
+    }
+    // 以nullptr结尾，按KEY排序
+    char *const *envp() const
+    {
+        return m_envp.data();
+    }
+    // 变量的值，不存在时返回nullptr
+    const char *value(const std::string &key) const;
+
+    // 叠加overlay(KEY=VALUE)后的envp，overlay中的变量替换或新增，以nullptr结尾。
+    // 返回的指针引用本对象及overlay中的字符串，只复制指针
+    std::vector<char *> merge(const std::vector<std::string> &overlay) const;
+
+private:
+    EnvironmentBlock(const EnvironmentBlock &);
+    EnvironmentBlock& operator= (const EnvironmentBlock &);
+
+    // KEY在m_envp中的下标，不存在时返回-1
+    long find(const char *key, size_t len) const;
+
+    std::unique_ptr<char[]> m_storage;
+    std::vector<char *> m_envp;
+};
+
+#endif // ENVIRONMENTBLOCK_H
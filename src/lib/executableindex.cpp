@@ -0,0 +1,157 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "executableindex.h"
+#include "dstring.h"
+
+#include <dirent.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+const uint32_t WatchMask = IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO
+                           | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR;
+
+bool exists(const std::string &dir, const std::string &name)
+{
+    return !access((dir + "/" + name).c_str(), F_OK);
+}
+
+} // namespace
+
+ExecutableIndex *ExecutableIndex::instance()
+{
+    static ExecutableIndex instance;
+    return &instance;
+}
+
+ExecutableIndex::ExecutableIndex()
+ : m_inotifyFd(inotify_init1(IN_NONBLOCK | IN_CLOEXEC))
+ , m_lastCheck(0)
+{
+    for (const auto &path : DString::splitChars(getenv("PATH"), ':')) {
+        PathDir dir;
+        dir.path = path;
+        m_dirs.push_back(dir);
+    }
+}
+
+ExecutableIndex::~ExecutableIndex()
+{
+    if (m_inotifyFd >= 0)
+        close(m_inotifyFd);
+}
+
+bool ExecutableIndex::contains(const std::string &name)
+{
+    // 带路径的名称无法用索引判断
+    if (name.empty() || name.find('/') != std::string::npos) {
+        return std::any_of(m_dirs.begin(), m_dirs.end(),
+                           [&name](const PathDir &dir) {return exists(dir.path, name);});
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    checkChanges();
+    for (auto &dir : m_dirs) {
+        if (dir.stale)
+            rebuild(dir);
+
+        auto iter = dir.names.find(name);
+        if (iter == dir.names.end())
+            continue;
+
+        // 链接需要确认目标存在，与access(F_OK)的结果保持一致
+        if (!iter->second || exists(dir.path, name))
+            return true;
+    }
+
+    return false;
+}
+
+void ExecutableIndex::checkChanges()
+{
+    if (m_inotifyFd >= 0) {
+        alignas(struct inotify_event) char buf[4096];
+        ssize_t len;
+        while ((len = read(m_inotifyFd, buf, sizeof(buf))) > 0) {
+            for (char *p = buf; p < buf + len;) {
+                const struct inotify_event *event = reinterpret_cast<const struct inotify_event *>(p);
+                p += sizeof(struct inotify_event) + event->len;
+
+                for (auto &dir : m_dirs) {
+                    if (event->mask & IN_Q_OVERFLOW) {
+                        dir.stale = true;
+                        continue;
+                    }
+
+                    if (dir.wd != event->wd)
+                        continue;
+
+                    dir.stale = true;
+                    if (event->mask & IN_IGNORED)
+                        dir.wd = -1;
+                }
+            }
+        }
+    }
+
+    // 没有被inotify监视的目录(inotify不可用或目录当时不存在)按mtime检查
+    time_t now = time(nullptr);
+    if (now == m_lastCheck)
+        return;
+
+    m_lastCheck = now;
+    for (auto &dir : m_dirs) {
+        if (dir.wd >= 0 || dir.stale)
+            continue;
+
+        struct stat st;
+        if (stat(dir.path.c_str(), &st) < 0) {
+            if (!dir.names.empty())
+                dir.stale = true;
+
+            continue;
+        }
+
+        if (st.st_mtim.tv_sec != dir.mtimeSec || st.st_mtim.tv_nsec != dir.mtimeNsec)
+            dir.stale = true;
+    }
+}
+
+void ExecutableIndex::rebuild(PathDir &dir)
+{
+    dir.stale = false;
+    dir.names.clear();
+    dir.mtimeSec = 0;
+    dir.mtimeNsec = 0;
+
+    // 先建立监视再读取目录，避免漏掉读取期间的变化
+    if (m_inotifyFd >= 0 && dir.wd < 0)
+        dir.wd = inotify_add_watch(m_inotifyFd, dir.path.c_str(), WatchMask);
+
+    struct stat st;
+    if (stat(dir.path.c_str(), &st) < 0)
+        return;
+
+    dir.mtimeSec = st.st_mtim.tv_sec;
+    dir.mtimeNsec = st.st_mtim.tv_nsec;
+
+    DIR *dp = opendir(dir.path.c_str());
+    if (!dp)
+        return;
+
+    struct dirent *ep;
+    while ((ep = readdir(dp))) {
+        if (!strcmp(ep->d_name, ".") || !strcmp(ep->d_name, ".."))
+            continue;
+
+        dir.names.insert({ep->d_name, ep->d_type == DT_LNK || ep->d_type == DT_UNKNOWN});
+    }
+    closedir(dp);
+}
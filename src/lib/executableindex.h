@@ -0,0 +1,53 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef EXECUTABLEINDEX_H
+#define EXECUTABLEINDEX_H
+
+#include <ctime>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief The ExecutableIndex class $PATH各目录下文件名的索引
+ * 查找可执行文件时不再逐个目录stat，目录内容变化由inotify通知，
+ * inotify不可用时按目录mtime检查(最多每秒一次)
+ */
+class ExecutableIndex
+{
+public:
+    static ExecutableIndex *instance();
+
+    // 与依次检查$PATH/name是否存在等价
+    bool contains(const std::string &name);
+
+private:
+    struct PathDir {
+        PathDir() : wd(-1), stale(true), mtimeSec(0), mtimeNsec(0) {}
+        std::string path;
+        int wd;
+        bool stale;
+        int64_t mtimeSec;
+        int64_t mtimeNsec;
+        std::unordered_map<std::string, bool> names; // 文件名 -> 是否需要确认链接目标存在
+    };
+
+    ExecutableIndex();
+    ~ExecutableIndex();
+    ExecutableIndex(const ExecutableIndex &);
+    ExecutableIndex& operator= (const ExecutableIndex &);
+
+    // 以下函数调用前须持有m_mutex
+    void checkChanges();
+    void rebuild(PathDir &dir);
+
+    std::mutex m_mutex;
+    std::vector<PathDir> m_dirs;
+    int m_inotifyFd;
+    time_t m_lastCheck;
+};
+
+#endif // EXECUTABLEINDEX_H
@@ -7,15 +7,86 @@
 #include "dstring.h"
 #include "macro.h"
 
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
 #include <cstring>
 #include <fstream>
 #include <string>
 #include <iostream>
+#include <iterator>
 #include <algorithm>
 
+namespace {
+
+std::string_view trim(std::string_view line)
+{
+    while (!line.empty() && std::isspace(static_cast<unsigned char>(line.front())))
+        line.remove_prefix(1);
+
+    while (!line.empty() && std::isspace(static_cast<unsigned char>(line.back())))
+        line.remove_suffix(1);
+
+    return line;
+}
+
+/**
+ * @brief scanKeyFile 逐行扫描ini内容，不做任何拷贝
+ * @param onSection 遇到section时回调
+ * @param onEntry 遇到键值时回调
+ * @return 键值出现在任何section之前时返回false
+ */
+template<typename SectionFunc, typename EntryFunc>
+bool scanKeyFile(std::string_view data, SectionFunc onSection, EntryFunc onEntry)
+{
+    std::string_view lastSection;
+    while (!data.empty()) {
+        size_t eol = data.find('\n');
+        std::string_view line = trim(data.substr(0, eol));
+        data.remove_prefix(eol == std::string_view::npos ? data.size() : eol + 1);
+
+        if (line.empty() || line.front() == '#')
+            continue;
+
+        if (line.front() == '[') {
+            auto rPos = line.find_first_of(']');
+            if (rPos != std::string_view::npos && 0 < rPos) {
+                // TODO(black_desk): lastSection might be empty string here.
+                // I cannot found a spec for the space before groupname in
+                // freedesktop.org
+                lastSection = line.substr(1, rPos - 1);
+                onSection(lastSection);
+            }
+            continue;
+        }
+
+        auto equalPos = line.find_first_of('=');
+        if (equalPos == std::string_view::npos)
+            continue;
+
+        // 文件格式错误
+        if (lastSection.empty())
+            return false;
+
+        // TODO(black_desk): we should check chars in key here, as spec says
+        // that it can only contain a-z0-9A-Z
+
+        // TODO(black_desk): space after value is removed before. But I cannot
+        // find a spec about this behavior.
+        onEntry(lastSection, line.substr(0, equalPos), line.substr(equalPos + 1));
+    }
+
+    return true;
+}
+
+} // namespace
+
 KeyFile::KeyFile(char separtor)
  : m_modified(false)
  , m_listSeparator(separtor)
+ , m_mapped(false)
 {
 }
 
@@ -25,10 +96,11 @@ KeyFile::~KeyFile()
 
 bool KeyFile::getBool(const std::string &section, const std::string &key, bool defaultValue)
 {
-    if (m_mainKeyMap.find(section) == m_mainKeyMap.end())
+    if (!hasSection(section))
         return false;
 
-    std::string valueStr = m_mainKeyMap[section][key];
+    std::string_view valueStr;
+    findValue(section, key, valueStr);
     bool value = defaultValue;
     if (valueStr == "true")
         value = true;
@@ -40,6 +112,7 @@ bool KeyFile::getBool(const std::string &section, const std::string &key, bool d
 
 void KeyFile::setBool(const std::string &section, const std::string &key, const std::string &defaultValue)
 {
+    detach();
     if (m_mainKeyMap.find(section) == m_mainKeyMap.end())
         m_mainKeyMap.insert({section, KeyMap()});
 
@@ -55,13 +128,14 @@ std::vector<bool> KeyFile::getBoolList(const std::string &section, const std::st
 
 int KeyFile::getInt(const std::string &section, const std::string &key, int defaultValue)
 {
-    if (m_mainKeyMap.find(section) == m_mainKeyMap.end())
+    if (!hasSection(section))
         return defaultValue;
 
-    std::string valueStr = m_mainKeyMap[section][key];
+    std::string_view valueStr;
+    findValue(section, key, valueStr);
     int value;
     try {
-        value = std::stoi(valueStr);
+        value = std::stoi(std::string(valueStr));
     } catch (std::invalid_argument&) {
         value = defaultValue;
     }
@@ -96,35 +170,32 @@ float KeyFile::getFloat(const std::string &section, const std::string &key, floa
 
 std::string KeyFile::getStr(const std::string &section, const std::string &key, std::string defaultValue)
 {
-    if (m_mainKeyMap.find(section) == m_mainKeyMap.end())
+    std::string_view valueStr;
+    if (!findValue(section, key, valueStr) || valueStr.empty())
         return defaultValue;
 
-    std::string valueStr = m_mainKeyMap[section][key];
-    if (valueStr.empty())
-        valueStr = defaultValue;
-
-    return valueStr;
+    return std::string(valueStr);
 }
 
 bool KeyFile::containKey(const std::string &section, const std::string &key)
 {
-    if (m_mainKeyMap.find(section) == m_mainKeyMap.end())
-        return false;
-
-    return m_mainKeyMap[section].find(key) != m_mainKeyMap[section].end();
+    std::string_view value;
+    return findValue(section, key, value);
 }
 
 std::string KeyFile::getLocaleStr(const std::string &section, const std::string &key, std::string defaultLocale)
 {
-    std::vector<std::string> languages = defaultLocale.empty()
-     ? Locale::instance()->getLanguageNames()
-     : Locale::instance()->getLocaleVariants(defaultLocale);
-
-    std::string translated;
-    for (const auto &lang : languages) {
-        translated.assign(getStr(section, key + "[" + lang + "]"));
-        if (!translated.empty())
-            return translated;
+    std::shared_ptr<const std::vector<std::string>> languages = defaultLocale.empty()
+     ? Locale::instance()->getSharedLanguageNames()
+     : std::make_shared<const std::vector<std::string>>(Locale::instance()->getLocaleVariants(defaultLocale));
+
+    // 复用同一个key缓冲区，只在找到翻译时拷贝value
+    std::string localeKey;
+    std::string_view translated;
+    for (const auto &lang : *languages) {
+        localeKey.assign(key).append(1, '[').append(lang).append(1, ']');
+        if (findValue(section, localeKey, translated) && !translated.empty())
+            return std::string(translated);
     }
 
     // NOTE: not support key Gettext-Domain
@@ -140,13 +211,18 @@ std::vector<std::string> KeyFile::getStrList(const std::string &section, const s
 
 std::vector<std::string> KeyFile::getLocaleStrList(const std::string &section, const std::string &key, std::string defaultLocale)
 {
-    std::vector<std::string> languages = defaultLocale.empty()
-     ? Locale::instance()->getLanguageNames()
-     : Locale::instance()->getLocaleVariants(defaultLocale);
+    std::shared_ptr<const std::vector<std::string>> languages = defaultLocale.empty()
+     ? Locale::instance()->getSharedLanguageNames()
+     : std::make_shared<const std::vector<std::string>>(Locale::instance()->getLocaleVariants(defaultLocale));
+
+    std::string localeKey;
+    std::string_view value;
+    for (const auto &lang : *languages) {
+        localeKey.assign(key).append(1, '[').append(lang).append(1, ']');
+        if (!findValue(section, localeKey, value) || value.empty())
+            continue;
 
-    std::vector<std::string> translated;
-    for (const auto &lang : languages) {
-        translated = getStrList(section, key + "[" + lang + "]");
+        std::vector<std::string> translated = DString::splitStr(std::string(value), m_listSeparator);
         if (translated.size() > 0)
             return translated;
     }
@@ -158,6 +234,7 @@ std::vector<std::string> KeyFile::getLocaleStrList(const std::string &section, c
 // 修改keyfile内容
 void KeyFile::setKey(const std::string &section, const std::string &key, const std::string &value)
 {
+    detach();
     if (m_mainKeyMap.find(section) == m_mainKeyMap.end())
         m_mainKeyMap.insert({section, KeyMap()});
 
@@ -167,6 +244,8 @@ void KeyFile::setKey(const std::string &section, const std::string &key, const s
 // 写入文件
 bool KeyFile::saveToFile(const std::string &filePath)
 {
+    detach();
+
     FILE *sfp = fopen(filePath.data(), "w+");
     if (!sfp) {
         perror("open file failed...");
@@ -202,88 +281,114 @@ bool KeyFile::writeSectionToFile(const std::string& sectionName, const KeyMap& k
 bool KeyFile::loadFile(const std::string &filePath)
 {
     m_mainKeyMap.clear();
+    m_mapped = false;
+    m_storage.reset();
+    m_mappedSections.clear();
+    m_mappedEntries.clear();
 
-    std::string lastSection;
     std::ifstream fs(filePath);
     if (!fs.is_open()) {
         perror("open file failed: ");
         return false;
     }
 
-    std::string line;
-    while (std::getline(fs, line)) {
-        line.erase(
-            line.begin(),
-            std::find_if(
-                line.begin(), line.end(),
-                std::not1(std::ptr_fun<int, int>(std::isspace))
-            )
-        );
-
-        if (line.front() == '#') {
-            continue;
-        }
+    std::string content((std::istreambuf_iterator<char>(fs)), std::istreambuf_iterator<char>());
+    bool ret = scanKeyFile(content,
+        [this](std::string_view section) {
+            m_mainKeyMap.insert({std::string(section), KeyMap()});
+        },
+        [this](std::string_view section, std::string_view key, std::string_view value) {
+            m_mainKeyMap[std::string(section)][std::string(key)] = std::string(value);
+        });
+
+    if (!ret) {
+        std::cout << "failed to load file " << filePath << std::endl;
+        return false;
+    }
 
-        line.erase(
-            std::find_if(
-                line.rbegin(), line.rend(),
-                std::not1(std::ptr_fun<int, int>(std::isspace))
-            ).base(),
-            line.end()
-        );
+    m_filePath = filePath;
 
-        if (line.front() == '[') {
-            auto rPos = line.find_first_of(']');
-            if ( rPos != std::string::npos && 0 < rPos ) {
-                // TODO(black_desk): lastSection might be empty string here.
-                // I cannot found a spec for the space before groupname in
-                // freedesktop.org
-                lastSection = line.substr(1, rPos-1);
+    return true;
+}
 
-                m_mainKeyMap.insert({
-                    lastSection,
-                    KeyMap()
-                });
+bool KeyFile::readFile(const std::string &filePath)
+{
+    m_mainKeyMap.clear();
+    m_mapped = false;
+    m_storage.reset();
+    m_mappedSections.clear();
+    m_mappedEntries.clear();
 
-            }
-            continue;
-        }
+    int fd = open(filePath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        perror("open file failed: ");
+        return false;
+    }
 
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+        close(fd);
+        return false;
+    }
 
-        auto equalPos = line.find_first_of('=');
+    // 不映射文件: 编辑器或saveToFile原地改写、截断文件时，映射中的内容会随之变化甚至触发SIGBUS
+    size_t size = 0;
+    if (st.st_size > 0) {
+        std::shared_ptr<char> buf(new char[size_t(st.st_size)], std::default_delete<char[]>());
+        while (size < size_t(st.st_size)) {
+            ssize_t len = read(fd, buf.get() + size, size_t(st.st_size) - size);
+            if (len < 0 && errno == EINTR)
+                continue;
+
+            if (len < 0) {
+                close(fd);
+                return false;
+            }
 
-        if (equalPos == std::string::npos) {
-            continue;
-        }
+            if (len == 0)
+                break;
 
-        // 文件格式错误
-        if (lastSection.empty()) {
-            std::cout << "failed to load file " << filePath << std::endl;
-            return false;
+            size += size_t(len);
         }
+        m_storage = std::move(buf);
+    }
+    close(fd);
 
-        // 子键
-
-        // TODO(black_desk): we should check chars in key here, as spec says
-        // that it can only contain a-z0-9A-Z
-        std::string key = line.substr(0, equalPos);
-        std::string value = equalPos + 1 < line.length() ?
-            line.substr(equalPos + 1) :
-            "";
-
-        // TODO(black_desk): space after value is removed before. But I cannot
-        // find a spec about this behavior.
-        m_mainKeyMap[lastSection][key] = value;
+    if (!parseMapped(std::string_view(m_storage.get(), m_storage ? size : 0))) {
+        std::cout << "failed to load file " << filePath << std::endl;
+        m_storage.reset();
+        m_mappedSections.clear();
+        m_mappedEntries.clear();
+        return false;
     }
 
+    m_mapped = true;
     m_filePath = filePath;
 
     return true;
 }
 
+void KeyFile::mapEntries(std::shared_ptr<const char> storage, std::vector<std::string_view> sections,
+                         std::vector<MappedEntry> entries, const std::string &filePath)
+{
+    m_mainKeyMap.clear();
+    m_storage = std::move(storage);
+    m_mappedSections = std::move(sections);
+    m_mappedEntries = std::move(entries);
+    m_mapped = true;
+    m_filePath = filePath;
+}
+
 std::vector<std::string> KeyFile::getMainKeys()
 {
     std::vector<std::string> mainKeys;
+    if (m_mapped) {
+        for (const auto &section : m_mappedSections)
+            mainKeys.emplace_back(section);
+
+        return mainKeys;
+    }
+
     for (const auto &iter : m_mainKeyMap)
         mainKeys.push_back(iter.first);
 
@@ -292,6 +397,8 @@ std::vector<std::string> KeyFile::getMainKeys()
 
 void KeyFile::print()
 {
+    detach();
+
     std::cout << "sectionMap: " << std::endl;
     for (auto sectionMap : m_mainKeyMap) {
         std::cout << "section=" << sectionMap.first << std::endl;
@@ -304,3 +411,90 @@ void KeyFile::print()
         std::cout << std::endl;
     }
 }
+
+void KeyFile::detach()
+{
+    if (!m_mapped)
+        return;
+
+    for (const auto &section : m_mappedSections)
+        m_mainKeyMap.insert({std::string(section), KeyMap()});
+
+    for (const auto &entry : m_mappedEntries)
+        m_mainKeyMap[std::string(entry.section)][std::string(entry.key)] = std::string(entry.value);
+
+    m_mapped = false;
+    m_storage.reset();
+    m_mappedSections.clear();
+    m_mappedEntries.clear();
+}
+
+bool KeyFile::hasSection(const std::string &section) const
+{
+    if (m_mapped)
+        return std::binary_search(m_mappedSections.begin(), m_mappedSections.end(), std::string_view(section));
+
+    return m_mainKeyMap.find(section) != m_mainKeyMap.end();
+}
+
+bool KeyFile::findValue(const std::string &section, const std::string &key, std::string_view &value) const
+{
+    if (m_mapped) {
+        const std::string_view s(section), k(key);
+        auto iter = std::lower_bound(m_mappedEntries.begin(), m_mappedEntries.end(), std::make_pair(s, k),
+                                     [](const MappedEntry &entry, const std::pair<std::string_view, std::string_view> &target) {
+                                         return entry.section < target.first
+                                                || (entry.section == target.first && entry.key < target.second);
+                                     });
+        if (iter == m_mappedEntries.end() || iter->section != s || iter->key != k)
+            return false;
+
+        value = iter->value;
+        return true;
+    }
+
+    auto sectionIter = m_mainKeyMap.find(section);
+    if (sectionIter == m_mainKeyMap.end())
+        return false;
+
+    auto keyIter = sectionIter->second.find(key);
+    if (keyIter == sectionIter->second.end())
+        return false;
+
+    value = keyIter->second;
+    return true;
+}
+
+bool KeyFile::parseMapped(std::string_view data)
+{
+    bool ret = scanKeyFile(data,
+        [this](std::string_view section) {
+            m_mappedSections.push_back(section);
+        },
+        [this](std::string_view section, std::string_view key, std::string_view value) {
+            m_mappedEntries.push_back({section, key, value});
+        });
+
+    if (!ret)
+        return false;
+
+    std::sort(m_mappedSections.begin(), m_mappedSections.end());
+    m_mappedSections.erase(std::unique(m_mappedSections.begin(), m_mappedSections.end()), m_mappedSections.end());
+
+    // 与std::map语义保持一致：同一section下重复的key以最后一次出现为准
+    auto less = [](const MappedEntry &a, const MappedEntry &b) {
+        return a.section < b.section || (a.section == b.section && a.key < b.key);
+    };
+    std::stable_sort(m_mappedEntries.begin(), m_mappedEntries.end(), less);
+
+    size_t count = 0;
+    for (size_t i = 0; i < m_mappedEntries.size(); i++) {
+        if (i + 1 < m_mappedEntries.size() && !less(m_mappedEntries[i], m_mappedEntries[i + 1]))
+            continue;
+
+        m_mappedEntries[count++] = m_mappedEntries[i];
+    }
+    m_mappedEntries.resize(count);
+
+    return true;
+}
@@ -6,7 +6,9 @@
 #define KEYFILE_H
 
 #include <string>
+#include <string_view>
 #include <map>
+#include <memory>
 #include <vector>
 #include <cstdint>
 
@@ -17,6 +19,13 @@ typedef std::map<std::string, KeyMap> MainKeyMap;
 class KeyFile
 {
 public:
+    // mapped模式下的一条键值，只引用m_storage中的数据(读入的文件内容或缓存文件的映射)，不持有数据
+    struct MappedEntry {
+        std::string_view section;
+        std::string_view key;
+        std::string_view value;
+    };
+
     explicit KeyFile(char separtor = ';');
     virtual ~KeyFile();
 
@@ -37,6 +46,24 @@ public:
     void setKey(const std::string &section, const std::string &key, const std::string &value);
     virtual bool saveToFile(const std::string &filePath);
     bool loadFile(const std::string &filePath);
+    // 整个文件读入共享的缓冲区，键值以string_view保存在有序数组中，
+    // 只有调用方需要std::string时才拷贝。调用setKey或saveToFile时自动转为普通模式
+    bool readFile(const std::string &filePath);
+    // 使用外部已解析好的数据(如DesktopEntryCache)进入mapped模式，sections与entries须有序且唯一
+    void mapEntries(std::shared_ptr<const char> storage, std::vector<std::string_view> sections,
+                    std::vector<MappedEntry> entries, const std::string &filePath);
+    bool isMapped() const
+    {
+        return m_mapped;
+    }
+    const std::vector<std::string_view> &mappedSections() const
+    {
+        return m_mappedSections;
+    }
+    const std::vector<MappedEntry> &mappedEntries() const
+    {
+        return m_mappedEntries;
+    }
     std::vector<std::string> getMainKeys();
     std::string getFilePath()
     {
@@ -47,12 +74,25 @@ public:
     void print();
 
 protected:
+    // 将mapped模式的数据拷贝到m_mainKeyMap，修改m_mainKeyMap之前必须调用
+    void detach();
+
     MainKeyMap m_mainKeyMap; // section -> key : value
     std::string m_filePath;
     bool m_modified;
     char m_listSeparator;
 
     static bool writeSectionToFile(const std::string& sectionName, const KeyMap& keyMap, FILE * file);
+
+private:
+    bool hasSection(const std::string &section) const;
+    bool findValue(const std::string &section, const std::string &key, std::string_view &value) const;
+    bool parseMapped(std::string_view data);
+
+    bool m_mapped;
+    std::shared_ptr<const char> m_storage;          // 文件内容或缓存的映射，拷贝KeyFile时共享
+    std::vector<std::string_view> m_mappedSections; // 有序且唯一
+    std::vector<MappedEntry> m_mappedEntries;       // 按section、key有序且唯一
 };
 
 #endif // KEYFILE_H
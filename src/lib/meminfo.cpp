@@ -3,57 +3,94 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 
 #include "meminfo.h"
-#include "macro.h"
-#include "dstring.h"
 
-#include <stdio.h>
-#include <string>
-#include <vector>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <cstddef>
+
+namespace {
+
+struct Field {
+    const char *name;
+    size_t len;
+    size_t offset;
+};
+
+#define MEMINFO_FIELD(name, member) { name, sizeof(name) - 1, offsetof(MemoryInfo, member) }
+const Field Fields[] = {
+    MEMINFO_FIELD("MemTotal", memTotal),
+    MEMINFO_FIELD("MemFree", memFree),
+    MEMINFO_FIELD("MemAvailable", memAvailable),
+    MEMINFO_FIELD("Buffers", buffers),
+    MEMINFO_FIELD("Cached", cached),
+    MEMINFO_FIELD("SwapCached", swapCached),
+    MEMINFO_FIELD("SwapTotal", swapTotal),
+    MEMINFO_FIELD("SwapFree", swapFree),
+};
+#undef MEMINFO_FIELD
+
+const size_t FieldCount = sizeof(Fields) / sizeof(Fields[0]);
+
+} // namespace
 
 MemInfo::MemInfo()
 {
 
 }
 
+// 在栈上读取并解析/proc/meminfo，不分配内存，可以频繁调用
 MemoryInfo MemInfo::getMemoryInfo()
 {
-    MemoryInfo ret;
-    FILE *fp = fopen("/proc/meminfo", "r");
-    if (!fp)
+    MemoryInfo ret = {};
+    int fd = open("/proc/meminfo", O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
         return ret;
 
-    char line[MAX_LINE_LEN] = {0};
-    while (fgets(line, MAX_LINE_LEN, fp)) {
-        std::string info(line);
-        std::vector<std::string> parts = DString::splitStr(info, ':');
-        if (parts.size() != 2)
-            continue;
-
-        uint64_t num = std::stoll(parts[1]);
-        if (parts[0] == "MemTotal") {
-            ret.memTotal = num;
-        }  else if (parts[0] == "MemFree") {
-            ret.memFree = num;
-        } else if (parts[0] == "MemAvailable") {
-            ret.memAvailable = num;
-        } else if (parts[0] == "Buffers") {
-            ret.buffers = num;
-        } else if (parts[0] == "Cached") {
-            ret.cached = num;
-        } else if (parts[0] == "SwapTotal") {
-            ret.swapTotal = num;
-        } else if (parts[0] == "SwapFree") {
-            ret.swapFree = num;
-        } else if (parts[0] == "SwapCached") {
-            ret.swapCached = num;
+    char buf[8192];
+    size_t len = 0;
+    ssize_t n;
+    while (len < sizeof(buf) && (n = read(fd, buf + len, sizeof(buf) - len)) > 0)
+        len += size_t(n);
+
+    close(fd);
+
+    size_t found = 0;
+    const char *end = buf + len;
+    for (const char *line = buf; line < end && found < FieldCount;) {
+        const char *eol = static_cast<const char *>(memchr(line, '\n', size_t(end - line)));
+        if (!eol)
+            eol = end;
+
+        const char *colon = static_cast<const char *>(memchr(line, ':', size_t(eol - line)));
+        if (colon) {
+            for (const Field &field : Fields) {
+                if (size_t(colon - line) != field.len || memcmp(line, field.name, field.len))
+                    continue;
+
+                uint64_t num = 0;
+                for (const char *p = colon + 1; p < eol; ++p) {
+                    if (*p >= '0' && *p <= '9')
+                        num = num * 10 + uint64_t(*p - '0');
+                    else if (num)
+                        break;
+                }
+
+                *reinterpret_cast<uint64_t *>(reinterpret_cast<char *>(&ret) + field.offset) = num;
+                ++found;
+                break;
+            }
         }
+
+        line = eol + 1;
     }
-    fclose(fp);
 
     return ret;
 }
 
 // IsSufficient check the memory whether reaches the qualified value
+// minMemAvail、maxSwapUsed单位为MB，与memchecker.json一致；/proc/meminfo中的值单位为KB
 bool MemInfo::isSufficient(uint64_t minMemAvail, uint64_t maxSwapUsed)
 {
     if (minMemAvail == 0)
@@ -62,11 +99,11 @@ bool MemInfo::isSufficient(uint64_t minMemAvail, uint64_t maxSwapUsed)
     MemoryInfo info = getMemoryInfo();
     uint64_t used = info.swapTotal - info.swapFree - info.swapCached;
 
-    if (info.memAvailable < minMemAvail)
+    if (info.memAvailable < minMemAvail * 1024)
         return false;
 
     if (maxSwapUsed == 0 || info.memAvailable > used)
         return true;
 
-    return used < maxSwapUsed;
+    return used < maxSwapUsed * 1024;
 }
@@ -0,0 +1,79 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "stringpool.h"
+
+StringPool *StringPool::instance()
+{
+    static StringPool instance;
+    return &instance;
+}
+
+StringPool::StringPool()
+{
+    // 0号句柄保留为无效句柄，不对应任何字符串
+    m_strings.append(QString());
+    m_lowers.append(InvalidHandle);
+}
+
+StringPool::Handle StringPool::intern(const QString &str)
+{
+    {
+        QReadLocker locker(&m_lock);
+        auto iter = m_handles.constFind(str);
+        if (iter != m_handles.constEnd())
+            return iter.value();
+    }
+
+    QWriteLocker locker(&m_lock);
+    auto iter = m_handles.constFind(str);
+    if (iter != m_handles.constEnd())
+        return iter.value();
+
+    Handle handle = Handle(m_strings.size());
+    m_strings.append(str);
+    m_lowers.append(InvalidHandle);
+    m_handles.insert(str, handle);
+    return handle;
+}
+
+StringPool::Handle StringPool::find(const QString &str) const
+{
+    QReadLocker locker(&m_lock);
+    return m_handles.value(str, InvalidHandle);
+}
+
+QString StringPool::string(Handle handle) const
+{
+    QReadLocker locker(&m_lock);
+    if (handle >= Handle(m_strings.size()))
+        return QString();
+
+    return m_strings.at(int(handle));
+}
+
+QString StringPool::internString(const QString &str)
+{
+    return string(intern(str));
+}
+
+StringPool::Handle StringPool::lower(Handle handle)
+{
+    QString str;
+    {
+        QReadLocker locker(&m_lock);
+        if (handle >= Handle(m_strings.size()))
+            return InvalidHandle;
+
+        if (m_lowers.at(int(handle)) != InvalidHandle || handle == InvalidHandle)
+            return m_lowers.at(int(handle));
+
+        str = m_strings.at(int(handle));
+    }
+
+    Handle lowerHandle = intern(str.toLower());
+    QWriteLocker locker(&m_lock);
+    m_lowers[int(handle)] = lowerHandle;
+    return lowerHandle;
+}
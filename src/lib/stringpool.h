@@ -0,0 +1,47 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef STRINGPOOL_H
+#define STRINGPOOL_H
+
+#include <QHash>
+#include <QReadWriteLock>
+#include <QString>
+#include <QVector>
+
+/**
+ * @brief The StringPool class 全局字符串驻留表
+ * 应用id、分类、MIME类型等重复出现的字符串只保存一份，并分配稳定的整数句柄，
+ * 以句柄为键的容器比较和哈希都只需处理整数。句柄在进程生命周期内有效
+ */
+class StringPool
+{
+public:
+    typedef quint32 Handle;
+    static const Handle InvalidHandle = 0;
+
+    static StringPool *instance();
+
+    // 返回字符串的句柄，不存在时加入字符串池
+    Handle intern(const QString &str);
+    // 只查询，不存在时返回InvalidHandle
+    Handle find(const QString &str) const;
+    // 与池中共享存储的字符串
+    QString string(Handle handle) const;
+    QString internString(const QString &str);
+    // 小写形式的句柄，每个字符串只转换一次
+    Handle lower(Handle handle);
+
+private:
+    StringPool();
+    StringPool(const StringPool &);
+    StringPool& operator= (const StringPool &);
+
+    mutable QReadWriteLock m_lock;
+    QHash<QString, Handle> m_handles;
+    QVector<QString> m_strings;  // 下标即句柄
+    QVector<Handle> m_lowers;    // InvalidHandle表示尚未计算
+};
+
+#endif // STRINGPOOL_H
@@ -2,14 +2,18 @@
 //
 // SPDX-License-Identifier: GPL-3.0-or-later
 
+#include <errno.h>
+#include <fcntl.h>
 #include <getopt.h>
 #include <grp.h>
+#include <poll.h>
 #include <pwd.h>
 #include <sched.h>
 #include <signal.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/prctl.h>
+#include <sys/signalfd.h>
 #include <sys/socket.h>
 #include <sys/stat.h>
 #include <sys/types.h>
@@ -17,8 +21,11 @@
 #include <sys/wait.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <filesystem>
 #include <iostream>
+#include <set>
+#include <sstream>
 #include <thread>
 #include <vector>
 
@@ -31,6 +38,7 @@
 #include "../modules/methods/process_status.hpp"
 #include "../modules/methods/registe.hpp"
 #include "../modules/methods/task.hpp"
+#include "../modules/methods/wire.h"
 #include "../modules/socket/client.h"
 #include "../modules/tools/desktop_deconstruction.hpp"
 #include "../modules/util/oci_runtime.h"
@@ -85,7 +93,8 @@ int childFreedesktop(Methods::Task* task, std::string path)
 
     DesktopDeconstruction dd(path);
     dd.beginGroup("Desktop Entry");
-    std::cout << dd.value<std::string>("Exec") << std::endl;
+    const std::string execLine = dd.string("Exec");
+    std::cout << execLine << std::endl;
 
     QStringList envs;
     for (auto it = task->environments.begin(); it != task->environments.end(); ++it) {
@@ -93,7 +102,7 @@ int childFreedesktop(Methods::Task* task, std::string path)
     }
 
     QStringList exeArgs;
-    exeArgs << QString::fromStdString(dd.value<std::string>("Exec")).split(" ");
+    exeArgs << QString::fromStdString(execLine).split(" ");
 
     QString exec = exeArgs[0];
     exeArgs.removeAt(0);
@@ -128,7 +137,8 @@ int childLinglong(Methods::Task* task, std::string path)
 
     DesktopDeconstruction dd(path);
     dd.beginGroup("Desktop Entry");
-    std::cout << dd.value<std::string>("Exec") << std::endl;
+    const std::string execLine = dd.string("Exec");
+    std::cout << execLine << std::endl;
 
     linglong::Runtime     runtime;
     linglong::Annotations annotations;
@@ -155,7 +165,7 @@ int childLinglong(Methods::Task* task, std::string path)
         runtime.process.env.append(it.key() + "=" + it.value());
     }
 
-    std::istringstream stream(dd.value<std::string>("Exec"));
+    std::istringstream stream(execLine);
     std::string        s;
     while (getline(stream, s, ' ')) {
         if (s.empty()) {
@@ -226,53 +236,23 @@ int childAndroid(Methods::Task* task, std::string path)
 #define DAM_TASK_HASH "DAM_TASK_HASH"
 #define DAM_TASK_TYPE "DAM_TASK_TYPE"
 
-int main(int argc, char* argv[])
+// 从AM交付的密封fd中读取启动信息
+static bool readTask(int fd, Methods::Task &task)
 {
-    const char* dam_task_hash = getenv(DAM_TASK_HASH);
-    if (!dam_task_hash) {
-        return -1;
+    std::vector<char> frame;
+    const bool valid = Methods::Wire::readSealedFd(fd, frame) && Methods::Wire::decode(frame, task);
+    close(fd);
+    if (!valid) {
+        qWarning() << "invalid task fd:" << fd;
     }
-    const char* dam_task_type = getenv(DAM_TASK_TYPE);
-    if (!dam_task_type) {
-        return -2;
-    }
-
-    char socketPath[50];
-    sprintf(socketPath, "/run/user/%d/dde-application-manager.socket", getuid());
-
-    // register client and run quitConnect
-    Socket::Client client;
-    client.connect(socketPath);
-
-    // 初始化应用注册信息
-    QByteArray registerArray;
-    Methods::Registe registe;
-    registe.id = dam_task_type;
-    registe.hash = dam_task_hash;
-    Methods::toJson(registerArray, registe);
-
-    // 向AM注册应用信息进行校验
-    Methods::Registe registe_result;
-    registe_result.state = false;
-    QByteArray result = client.get(registerArray);
-    if (!result.isEmpty()) {
-        Methods::fromJson(result, registe_result);
-    }
-    if (!registe_result.state) {
-        return -3;
-    }
-
-    // 初始化应用实例信息
-    Methods::Instance instance;
-    instance.hash = registe_result.hash;
-    QByteArray instanceArray;
-    Methods::toJson(instanceArray, instance);
+    return valid;
+}
 
-    // 向AM注册应用实例信息进行校验
-    result = client.get(instanceArray);
-    Methods::Task task;
-    Methods::fromJson(result, task);       // fromJson TODO 数据解析异常
-    qInfo() << "[Task] " << result;
+// 启动应用，向AM上报启动结果，并等待应用退出
+static int runTask(Socket::Client &client, Methods::Task &task)
+{
+    qInfo() << "[Task] " << "id:" << task.id << "runId:" << task.runId << "filePath:" << task.filePath
+            << "arguments:" << task.arguments.size() << "environments:" << task.environments.size();
 
     // 校验task内容
     App app = parseApp(task.runId);
@@ -322,9 +302,7 @@ int main(int argc, char* argv[])
         processSuccess.id   = task.id;
         processSuccess.type = "success";
         processSuccess.data = QString::number(pid);
-        QByteArray processArray;
-        Methods::toJson(processArray, processSuccess);
-        client.send(processArray);
+        client.send(Methods::Wire::encode(processSuccess));
     }
 
     // TODO: 启动线程，创建新的连接去接受服务器的消息
@@ -348,9 +326,220 @@ int main(int argc, char* argv[])
     quit.code = exitCode;
     quit.id   = task.id;
     quit.type = "quit";
-    QByteArray quitArray;
-    Methods::toJson(quitArray, quit);
-    client.send(quitArray);
+    client.send(Methods::Wire::encode(quit));
 
     return exitCode;
 }
+
+// zygote的worker，预先连接AM，取得一个任务后执行
+static int zygoteWorker(int controlFd, int notifyFd, const char *socketPath)
+{
+    Socket::Client client;
+    client.connect(socketPath);
+
+    std::string hash;
+    const int taskFd = Methods::Wire::recvTaskFd(controlFd, hash);
+    close(controlFd);
+
+    // 通知zygote补充worker，失败时zygote要等本进程退出才会补充
+    const pid_t self = getpid();
+    ssize_t ret;
+    do {
+        ret = write(notifyFd, &self, sizeof(self));
+    } while (ret < 0 && errno == EINTR);
+    if (ret != ssize_t(sizeof(self))) {
+        perror("write() notify");
+    }
+    close(notifyFd);
+
+    if (taskFd < 0) {
+        return 0;
+    }
+
+    qInfo() << "[Zygote] task:" << QString::fromStdString(hash);
+    Methods::Task task;
+    if (!readTask(taskFd, task)) {
+        return -3;
+    }
+
+    return runTask(client, task);
+}
+
+/**
+ * zygote模式: 常驻进程，保持poolSize个已初始化的worker等待任务，
+ * worker取走任务后再fork新的worker补充。AM关闭控制套接字后退出。
+ */
+static int zygoteMain(const char *socketPath)
+{
+    const char* dam_zygote_fd = getenv(Methods::Wire::ZygoteFdEnv);
+    if (!dam_zygote_fd) {
+        return -1;
+    }
+    const int controlFd = atoi(dam_zygote_fd);
+    fcntl(controlFd, F_SETFD, FD_CLOEXEC);
+    unsetenv(Methods::Wire::ZygoteFdEnv);
+
+    int poolSize = 1;
+    if (const char *pool = getenv(Methods::Wire::ZygotePoolEnv)) {
+        poolSize = std::max(1, std::min(atoi(pool), 16));
+        unsetenv(Methods::Wire::ZygotePoolEnv);
+    }
+
+    prctl(PR_SET_PDEATHSIG, SIGTERM);
+
+    int notifyPipe[2];
+    if (pipe2(notifyPipe, O_CLOEXEC) < 0) {
+        perror("pipe2()");
+        return -1;
+    }
+
+    // 通过signalfd回收worker，worker中恢复原来的信号掩码
+    sigset_t mask, oldMask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGCHLD);
+    sigprocmask(SIG_BLOCK, &mask, &oldMask);
+    const int signalFd = signalfd(-1, &mask, SFD_CLOEXEC);
+    if (signalFd < 0) {
+        perror("signalfd()");
+    }
+
+    std::set<pid_t> idle;
+    while (true) {
+        while (int(idle.size()) < poolSize) {
+            const pid_t pid = fork();
+            if (pid < 0) {
+                perror("fork()");
+                break;
+            }
+
+            if (pid == 0) {
+                close(signalFd);
+                close(notifyPipe[0]);
+                sigprocmask(SIG_SETMASK, &oldMask, nullptr);
+                exit(zygoteWorker(controlFd, notifyPipe[1], socketPath));
+            }
+
+            idle.insert(pid);
+        }
+
+        struct pollfd fds[3] = {
+            { controlFd, 0, 0 },
+            { notifyPipe[0], POLLIN, 0 },
+            { signalFd, POLLIN, 0 },
+        };
+        if (poll(fds, signalFd < 0 ? 2 : 3, signalFd < 0 ? 1000 : -1) < 0 && errno != EINTR) {
+            perror("poll()");
+            break;
+        }
+
+        if (fds[0].revents & (POLLHUP | POLLERR)) {
+            qInfo() << "[Zygote] control socket closed";
+            break;
+        }
+
+        if (fds[1].revents & POLLIN) {
+            pid_t pids[16];
+            const ssize_t n = read(notifyPipe[0], pids, sizeof(pids));
+            for (ssize_t i = 0; i < n / ssize_t(sizeof(pid_t)); ++i) {
+                idle.erase(pids[i]);
+            }
+        }
+
+        if (signalFd < 0 || (fds[2].revents & POLLIN)) {
+            struct signalfd_siginfo info;
+            if (signalFd >= 0) {
+                ssize_t ret;
+                do {
+                    ret = read(signalFd, &info, sizeof(info));
+                } while (ret < 0 && errno == EINTR);
+                if (ret < 0) {
+                    perror("read() signalfd");
+                }
+            }
+
+            // 空闲时意外退出的worker也需要补充
+            pid_t pid;
+            while ((pid = waitpid(-1, nullptr, WNOHANG)) > 0) {
+                idle.erase(pid);
+            }
+        }
+    }
+
+    return 0;
+}
+
+int main(int argc, char* argv[])
+{
+    static const struct option options[] = {
+        { "zygote", no_argument, nullptr, 'z' },
+        { nullptr, 0, nullptr, 0 },
+    };
+    bool zygote = false;
+    int opt;
+    while ((opt = getopt_long(argc, argv, "", options, nullptr)) != -1) {
+        if (opt == 'z') {
+            zygote = true;
+        }
+    }
+
+    char socketPath[50];
+    sprintf(socketPath, "/run/user/%d/dde-application-manager.socket", getuid());
+
+    if (zygote) {
+        return zygoteMain(socketPath);
+    }
+
+    const char* dam_task_hash = getenv(DAM_TASK_HASH);
+    if (!dam_task_hash) {
+        return -1;
+    }
+    const char* dam_task_type = getenv(DAM_TASK_TYPE);
+    if (!dam_task_type) {
+        return -2;
+    }
+
+    // register client and run quitConnect
+    Socket::Client client;
+    client.connect(socketPath);
+
+    Methods::Task task;
+    const char* dam_task_fd = getenv(Methods::Wire::TaskFdEnv);
+    if (dam_task_fd) {
+        // AM启动loader时已通过密封的memfd交付启动信息，无需注册
+        const int fd = atoi(dam_task_fd);
+        unsetenv(Methods::Wire::TaskFdEnv);
+        if (!readTask(fd, task)) {
+            return -3;
+        }
+    } else {
+        // 初始化应用注册信息
+        Methods::Registe registe;
+        registe.id = dam_task_type;
+        registe.hash = dam_task_hash;
+
+        // 向AM注册应用信息进行校验
+        Methods::Registe registe_result;
+        registe_result.state = false;
+        std::vector<char> result = client.get(Methods::Wire::encode(registe));
+        if (!Methods::Wire::decode(result, registe_result)) {
+            qWarning() << "invalid registe frame, size:" << result.size();
+            return -3;
+        }
+        if (!registe_result.state) {
+            return -3;
+        }
+
+        // 初始化应用实例信息
+        Methods::Instance instance;
+        instance.hash = registe_result.hash;
+
+        // 向AM注册应用实例信息进行校验
+        result = client.get(Methods::Wire::encode(instance));
+        if (!Methods::Wire::decode(result, task)) {
+            qWarning() << "invalid task frame, size:" << result.size();
+            return -3;
+        }
+    }
+
+    return runTask(client, task);
+}
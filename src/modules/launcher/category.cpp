@@ -4,6 +4,359 @@
 
 #include "category.h"
 
+#include <cstdint>
+
+namespace {
+
+struct CategoryName {
+    const char *name;
+    Categorytype type;
+    Categorytype extra = Categorytype::CategoryErr; // 第二个类型，CategoryErr表示没有
+};
+
+constexpr CategoryName CategoryNames[] = {
+    {"internet",    Categorytype::CategoryInternet},
+    {"chat",        Categorytype::CategoryChat},
+    {"music",       Categorytype::CategoryMusic},
+    {"video",       Categorytype::CategoryVideo},
+    {"graphics",    Categorytype::CategoryGraphics},
+    {"office",      Categorytype::CategoryOffice},
+    {"game",        Categorytype::CategoryGame},
+    {"reading",     Categorytype::CategoryReading},
+    {"development", Categorytype::CategoryDevelopment},
+    {"system",      Categorytype::CategorySystem},
+    {"others",      Categorytype::CategoryOthers},
+};
+
+// 同时属于音乐和视频的类型按视频、音乐的顺序返回，与原先QMultiMap::values()的结果一致
+constexpr CategoryName XCategoryNames[] = {
+    {"2dgraphics",                              Categorytype::CategoryGraphics},
+    {"3dgraphics",                              Categorytype::CategoryGraphics},
+    {"accessibility",                           Categorytype::CategorySystem},
+    {"accessories",                             Categorytype::CategoryOthers},
+    {"actiongame",                              Categorytype::CategoryGame},
+    {"advancedsettings",                        Categorytype::CategorySystem},
+    {"adventuregame",                           Categorytype::CategoryGame},
+    {"amusement",                               Categorytype::CategoryGame},
+    {"applet",                                  Categorytype::CategoryOthers},
+    {"arcadegame",                              Categorytype::CategoryGame},
+    {"archiving",                               Categorytype::CategorySystem},
+    {"art",                                     Categorytype::CategoryOffice},
+    {"artificialintelligence",                  Categorytype::CategoryOffice},
+    {"astronomy",                               Categorytype::CategoryOffice},
+    {"audio",                                   Categorytype::CategoryMusic},
+    {"audiovideo",                              Categorytype::CategoryVideo, Categorytype::CategoryMusic},
+    {"audiovideoediting",                       Categorytype::CategoryVideo, Categorytype::CategoryMusic},
+    {"biology",                                 Categorytype::CategoryOffice},
+    {"blocksgame",                              Categorytype::CategoryGame},
+    {"boardgame",                               Categorytype::CategoryGame},
+    {"building",                                Categorytype::CategoryDevelopment},
+    {"calculator",                              Categorytype::CategorySystem},
+    {"calendar",                                Categorytype::CategorySystem},
+    {"cardgame",                                Categorytype::CategoryGame},
+    {"cd",                                      Categorytype::CategoryMusic},
+    {"chart",                                   Categorytype::CategoryOffice},
+    {"chat",                                    Categorytype::CategoryChat},
+    {"chemistry",                               Categorytype::CategoryOffice},
+    {"clock",                                   Categorytype::CategorySystem},
+    {"compiz",                                  Categorytype::CategorySystem},
+    {"compression",                             Categorytype::CategorySystem},
+    {"computerscience",                         Categorytype::CategoryOffice},
+    {"consoleonly",                             Categorytype::CategoryOthers},
+    {"contactmanagement",                       Categorytype::CategoryChat},
+    {"core",                                    Categorytype::CategoryOthers},
+    {"debugger",                                Categorytype::CategoryDevelopment},
+    {"desktopsettings",                         Categorytype::CategorySystem},
+    {"desktoputility",                          Categorytype::CategorySystem},
+    {"development",                             Categorytype::CategoryDevelopment},
+    {"dialup",                                  Categorytype::CategorySystem},
+    {"dictionary",                              Categorytype::CategoryOffice},
+    {"discburning",                             Categorytype::CategorySystem},
+    {"documentation",                           Categorytype::CategoryOffice},
+    {"editors",                                 Categorytype::CategoryOthers},
+    {"education",                               Categorytype::CategoryOffice},
+    {"electricity",                             Categorytype::CategoryOffice},
+    {"electronics",                             Categorytype::CategoryOffice},
+    {"email",                                   Categorytype::CategoryInternet},
+    {"emulator",                                Categorytype::CategoryGame},
+    {"engineering",                             Categorytype::CategorySystem},
+    {"favorites",                               Categorytype::CategoryOthers},
+    {"filemanager",                             Categorytype::CategorySystem},
+    {"filesystem",                              Categorytype::CategorySystem},
+    {"filetools",                               Categorytype::CategorySystem},
+    {"filetransfer",                            Categorytype::CategoryInternet},
+    {"finance",                                 Categorytype::CategoryOffice},
+    {"game",                                    Categorytype::CategoryGame},
+    {"geography",                               Categorytype::CategoryOffice},
+    {"geology",                                 Categorytype::CategoryOffice},
+    {"geoscience",                              Categorytype::CategoryOthers},
+    {"gnome",                                   Categorytype::CategorySystem},
+    {"gpe",                                     Categorytype::CategoryOthers},
+    {"graphics",                                Categorytype::CategoryGraphics},
+    {"guidesigner",                             Categorytype::CategoryDevelopment},
+    {"hamradio",                                Categorytype::CategoryOffice},
+    {"hardwaresettings",                        Categorytype::CategorySystem},
+    {"ide",                                     Categorytype::CategoryDevelopment},
+    {"imageprocessing",                         Categorytype::CategoryGraphics},
+    {"instantmessaging",                        Categorytype::CategoryChat},
+    {"internet",                                Categorytype::CategoryInternet},
+    {"ircclient",                               Categorytype::CategoryChat},
+    {"kde",                                     Categorytype::CategorySystem},
+    {"kidsgame",                                Categorytype::CategoryGame},
+    {"literature",                              Categorytype::CategoryOffice},
+    {"logicgame",                               Categorytype::CategoryGame},
+    {"math",                                    Categorytype::CategoryOffice},
+    {"medicalsoftware",                         Categorytype::CategoryOffice},
+    {"meteorology",                             Categorytype::CategoryOthers},
+    {"midi",                                    Categorytype::CategoryMusic},
+    {"mixer",                                   Categorytype::CategoryMusic},
+    {"monitor",                                 Categorytype::CategorySystem},
+    {"motif",                                   Categorytype::CategoryOthers},
+    {"multimedia",                              Categorytype::CategoryVideo},
+    {"music",                                   Categorytype::CategoryMusic},
+    {"network",                                 Categorytype::CategoryInternet},
+    {"news",                                    Categorytype::CategoryReading},
+    {"numericalanalysis",                       Categorytype::CategoryOffice},
+    {"ocr",                                     Categorytype::CategoryGraphics},
+    {"office",                                  Categorytype::CategoryOffice},
+    {"p2p",                                     Categorytype::CategoryInternet},
+    {"packagemanager",                          Categorytype::CategorySystem},
+    {"panel",                                   Categorytype::CategorySystem},
+    {"pda",                                     Categorytype::CategorySystem},
+    {"photography",                             Categorytype::CategoryGraphics},
+    {"physics",                                 Categorytype::CategoryOffice},
+    {"pim",                                     Categorytype::CategoryOthers},
+    {"player",                                  Categorytype::CategoryVideo, Categorytype::CategoryMusic},
+    {"playonlinux",                             Categorytype::CategoryOthers},
+    {"presentation",                            Categorytype::CategoryOffice},
+    {"printing",                                Categorytype::CategoryOffice},
+    {"profiling",                               Categorytype::CategoryDevelopment},
+    {"projectmanagement",                       Categorytype::CategoryOffice},
+    {"publishing",                              Categorytype::CategoryOffice},
+    {"puzzlegame",                              Categorytype::CategoryGame},
+    {"rastergraphics",                          Categorytype::CategoryGraphics},
+    {"recorder",                                Categorytype::CategoryVideo, Categorytype::CategoryMusic},
+    {"remoteaccess",                            Categorytype::CategorySystem},
+    {"revisioncontrol",                         Categorytype::CategoryDevelopment},
+    {"robotics",                                Categorytype::CategoryOffice},
+    {"roleplaying",                             Categorytype::CategoryGame},
+    {"scanning",                                Categorytype::CategoryOffice},
+    {"science",                                 Categorytype::CategoryOffice},
+    {"screensaver",                             Categorytype::CategoryOthers},
+    {"sequencer",                               Categorytype::CategoryMusic},
+    {"settings",                                Categorytype::CategorySystem},
+    {"security",                                Categorytype::CategorySystem},
+    {"simulation",                              Categorytype::CategoryGame},
+    {"sportsgame",                              Categorytype::CategoryGame},
+    {"spreadsheet",                             Categorytype::CategoryOffice},
+    {"strategygame",                            Categorytype::CategoryGame},
+    {"system",                                  Categorytype::CategorySystem},
+    {"systemsettings",                          Categorytype::CategorySystem},
+    {"technical",                               Categorytype::CategoryOthers},
+    {"telephony",                               Categorytype::CategorySystem},
+    {"telephonytools",                          Categorytype::CategorySystem},
+    {"terminalemulator",                        Categorytype::CategorySystem},
+    {"texteditor",                              Categorytype::CategoryOffice},
+    {"texttools",                               Categorytype::CategoryOffice},
+    {"transiation",                             Categorytype::CategoryDevelopment},
+    {"translation",                             Categorytype::CategoryReading},
+    {"trayicon",                                Categorytype::CategorySystem},
+    {"tuner",                                   Categorytype::CategoryMusic},
+    {"tv",                                      Categorytype::CategoryVideo},
+    {"utility",                                 Categorytype::CategorySystem},
+    {"vectorgraphics",                          Categorytype::CategoryGraphics},
+    {"video",                                   Categorytype::CategoryVideo},
+    {"videoconference",                         Categorytype::CategoryInternet},
+    {"viewer",                                  Categorytype::CategoryGraphics},
+    {"webbrowser",                              Categorytype::CategoryInternet},
+    {"webdevelopment",                          Categorytype::CategoryDevelopment},
+    {"wine",                                    Categorytype::CategoryOthers},
+    {"wine-programs-accessories",               Categorytype::CategoryOthers},
+    {"wordprocessor",                           Categorytype::CategoryOffice},
+    {"x-alsa",                                  Categorytype::CategoryMusic},
+    {"x-bible",                                 Categorytype::CategoryReading},
+    {"x-bluetooth",                             Categorytype::CategorySystem},
+    {"x-debian-applications-emulators",         Categorytype::CategoryGame},
+    {"x-digital_processing",                    Categorytype::CategorySystem},
+    {"x-enlightenment",                         Categorytype::CategorySystem},
+    {"x-geeqie",                                Categorytype::CategoryGraphics},
+    {"x-gnome-networksettings",                 Categorytype::CategorySystem},
+    {"x-gnome-personalsettings",                Categorytype::CategorySystem},
+    {"x-gnome-settings-panel",                  Categorytype::CategorySystem},
+    {"x-gnome-systemsettings",                  Categorytype::CategorySystem},
+    {"x-gnustep",                               Categorytype::CategorySystem},
+    {"x-islamic-software",                      Categorytype::CategoryReading},
+    {"x-jack",                                  Categorytype::CategoryMusic},
+    {"x-kde-edu-misc",                          Categorytype::CategoryReading},
+    {"x-kde-internet",                          Categorytype::CategorySystem},
+    {"x-kde-more",                              Categorytype::CategorySystem},
+    {"x-kde-utilities-desktop",                 Categorytype::CategorySystem},
+    {"x-kde-utilities-file",                    Categorytype::CategorySystem},
+    {"x-kde-utilities-peripherals",             Categorytype::CategorySystem},
+    {"x-kde-utilities-pim",                     Categorytype::CategorySystem},
+    {"x-lxde-settings",                         Categorytype::CategorySystem},
+    {"x-mandriva-office-publishing",            Categorytype::CategoryOthers},
+    {"x-mandrivalinux-internet-other",          Categorytype::CategorySystem},
+    {"x-mandrivalinux-office-other",            Categorytype::CategoryOffice},
+    {"x-mandrivalinux-system-archiving-backup", Categorytype::CategorySystem},
+    {"x-midi",                                  Categorytype::CategoryMusic},
+    {"x-misc",                                  Categorytype::CategorySystem},
+    {"x-multitrack",                            Categorytype::CategoryMusic},
+    {"x-novell-main",                           Categorytype::CategorySystem},
+    {"x-quran",                                 Categorytype::CategoryReading},
+    {"x-red-hat-base",                          Categorytype::CategorySystem},
+    {"x-red-hat-base-only",                     Categorytype::CategorySystem},
+    {"x-red-hat-extra",                         Categorytype::CategorySystem},
+    {"x-red-hat-serverconfig",                  Categorytype::CategorySystem},
+    {"x-religion",                              Categorytype::CategoryReading},
+    {"x-sequencers",                            Categorytype::CategoryMusic},
+    {"x-sound",                                 Categorytype::CategoryMusic},
+    {"x-sun-supported",                         Categorytype::CategorySystem},
+    {"x-suse-backup",                           Categorytype::CategorySystem},
+    {"x-suse-controlcenter-lookandfeel",        Categorytype::CategorySystem},
+    {"x-suse-controlcenter-system",             Categorytype::CategorySystem},
+    {"x-suse-core",                             Categorytype::CategorySystem},
+    {"x-suse-core-game",                        Categorytype::CategoryGame},
+    {"x-suse-core-office",                      Categorytype::CategoryOffice},
+    {"x-suse-sequencer",                        Categorytype::CategoryMusic},
+    {"x-suse-yast",                             Categorytype::CategorySystem},
+    {"x-suse-yast-high_availability",           Categorytype::CategorySystem},
+    {"x-synthesis",                             Categorytype::CategorySystem},
+    {"x-turbolinux-office",                     Categorytype::CategoryOffice},
+    {"x-xfce",                                  Categorytype::CategorySystem},
+    {"x-xfce-toplevel",                         Categorytype::CategorySystem},
+    {"x-xfcesettingsdialog",                    Categorytype::CategorySystem},
+    {"x-ximian-main",                           Categorytype::CategorySystem},
+};
+
+constexpr uint32_t lowerAscii(uint32_t c)
+{
+    return c >= 'A' && c <= 'Z' ? c + ('a' - 'A') : c;
+}
+
+// 忽略ASCII大小写的FNV-1a，编译期(char)与运行期(QChar)使用同一实现
+template<typename Char>
+constexpr uint32_t hashName(const Char *data, int len, uint32_t seed)
+{
+    uint32_t hash = 2166136261u ^ (seed * 0x9e3779b9u);
+    for (int i = 0; i < len; ++i) {
+        hash ^= lowerAscii(static_cast<uint32_t>(data[i]));
+        hash *= 16777619u;
+    }
+    hash ^= hash >> 15;
+    hash *= 0x2c1b3c6du;
+    hash ^= hash >> 12;
+    return hash;
+}
+
+constexpr int nameLength(const char *name)
+{
+    int len = 0;
+    while (name[len])
+        ++len;
+    return len;
+}
+
+/**
+ * @brief The PerfectHash struct 编译期生成的完美哈希表(hash and displace)
+ * 名称先按种子0分桶，每个桶再选取一个种子，使桶内名称落到互不冲突的空槽位，
+ * 查找时固定计算两次哈希并比较一次字符串
+ */
+template<int Buckets, int Slots>
+struct PerfectHash {
+    uint32_t seeds[Buckets];
+    int16_t slots[Slots]; // CategoryName下标，-1为空
+    bool ok;
+};
+
+template<int Buckets, int Slots, int N>
+constexpr PerfectHash<Buckets, Slots> buildPerfectHash(const CategoryName (&names)[N])
+{
+    PerfectHash<Buckets, Slots> table {};
+    for (int i = 0; i < Slots; ++i)
+        table.slots[i] = -1;
+
+    int bucketOf[N] {};
+    int bucketSize[Buckets] {};
+    for (int i = 0; i < N; ++i) {
+        bucketOf[i] = hashName(names[i].name, nameLength(names[i].name), 0) % Buckets;
+        ++bucketSize[bucketOf[i]];
+    }
+
+    // 先放置名称多的桶
+    bool placed[Buckets] {};
+    for (int round = 0; round < Buckets; ++round) {
+        int bucket = -1;
+        for (int i = 0; i < Buckets; ++i) {
+            if (!placed[i] && (bucket < 0 || bucketSize[i] > bucketSize[bucket]))
+                bucket = i;
+        }
+        placed[bucket] = true;
+        if (bucketSize[bucket] == 0)
+            break;
+
+        bool found = false;
+        for (uint32_t seed = 1; seed < 100000 && !found; ++seed) {
+            int used[N] {};
+            int count = 0;
+            found = true;
+            for (int i = 0; i < N && found; ++i) {
+                if (bucketOf[i] != bucket)
+                    continue;
+
+                const int slot = hashName(names[i].name, nameLength(names[i].name), seed) % Slots;
+                found = table.slots[slot] < 0;
+                for (int j = 0; j < count && found; ++j)
+                    found = used[j] != slot;
+
+                used[count++] = slot;
+            }
+
+            if (!found)
+                continue;
+
+            table.seeds[bucket] = seed;
+            for (int i = 0, j = 0; i < N; ++i) {
+                if (bucketOf[i] == bucket)
+                    table.slots[used[j++]] = static_cast<int16_t>(i);
+            }
+        }
+
+        if (!found)
+            return table;
+    }
+
+    table.ok = true;
+    return table;
+}
+
+constexpr auto CategoryTable = buildPerfectHash<4, 32>(CategoryNames);
+constexpr auto XCategoryTable = buildPerfectHash<64, 512>(XCategoryNames);
+static_assert(CategoryTable.ok, "failed to build category hash table");
+static_assert(XCategoryTable.ok, "failed to build xcategory hash table");
+
+// 忽略大小写查找，不分配内存
+template<int Buckets, int Slots, int N>
+const CategoryName *findName(const PerfectHash<Buckets, Slots> &table, const CategoryName (&names)[N], const QString &str)
+{
+    const ushort *data = reinterpret_cast<const ushort *>(str.constData());
+    const int len = str.size();
+    const uint32_t seed = table.seeds[hashName(data, len, 0) % Buckets];
+    const int index = table.slots[hashName(data, len, seed) % Slots];
+    if (index < 0)
+        return nullptr;
+
+    const char *name = names[index].name;
+    for (int i = 0; i < len; ++i) {
+        if (!name[i] || lowerAscii(data[i]) != static_cast<uint32_t>(name[i]))
+            return nullptr;
+    }
+
+    return name[len] ? nullptr : &names[index];
+}
+
+} // namespace
+
 Category::Category()
 {
 
@@ -15,260 +368,70 @@ Category::~Category()
 }
 
 QString Category::getStr(Categorytype ty) {
-    QMap<Categorytype, QString> ty2str = {
-        {Categorytype::CategoryInternet, "Internet"},
-        {Categorytype::CategoryChat, "Chat"},
-        {Categorytype::CategoryMusic, "Music"},
-        {Categorytype::CategoryVideo, "Video"},
-        {Categorytype::CategoryGraphics, "Graphics"},
-        {Categorytype::CategoryOffice, "Office"},
-        {Categorytype::CategoryGame, "Game"},
-        {Categorytype::CategoryReading, "Reading"},
-        {Categorytype::CategoryDevelopment, "Development"},
-        {Categorytype::CategorySystem, "System"},
-        {Categorytype::CategoryOthers, "Others"},
+    // 按Categorytype的顺序
+    static const QString ty2str[] = {
+        QStringLiteral("Internet"),
+        QStringLiteral("Chat"),
+        QStringLiteral("Music"),
+        QStringLiteral("Video"),
+        QStringLiteral("Graphics"),
+        QStringLiteral("Game"),
+        QStringLiteral("Office"),
+        QStringLiteral("Reading"),
+        QStringLiteral("Development"),
+        QStringLiteral("System"),
+        QStringLiteral("Others"),
     };
-    return ty2str.find(ty) != ty2str.end() ? ty2str[ty] : "Others";
+    static_assert(sizeof(ty2str) / sizeof(ty2str[0]) == int(Categorytype::CategoryErr), "missing category name");
+
+    const int index = int(ty);
+    return index >= 0 && index < int(Categorytype::CategoryErr) ? ty2str[index] : ty2str[int(Categorytype::CategoryOthers)];
 }
 
 QString Category::pinYin(Categorytype ty) {
-    QMap<Categorytype, QString> ty2py = {
-        {Categorytype::CategoryInternet, "wangluo"},
-        {Categorytype::CategoryChat, "shejiaogoutong"},
-        {Categorytype::CategoryMusic, "yinyuexinshang"},
-        {Categorytype::CategoryVideo, "shipinbofang"},
-        {Categorytype::CategoryGraphics, "tuxintuxiang"},
-        {Categorytype::CategoryOffice, "bangongxuexi"},
-        {Categorytype::CategoryGame, "youxiyule"},
-        {Categorytype::CategoryReading, "yuedufanyi"},
-        {Categorytype::CategoryDevelopment, "bianchengkaifai"},
-        {Categorytype::CategorySystem, "xitongguanli"},
-        {Categorytype::CategoryOthers, "qita"},
+    // 按Categorytype的顺序
+    static const QString ty2py[] = {
+        QStringLiteral("wangluo"),
+        QStringLiteral("shejiaogoutong"),
+        QStringLiteral("yinyuexinshang"),
+        QStringLiteral("shipinbofang"),
+        QStringLiteral("tuxintuxiang"),
+        QStringLiteral("youxiyule"),
+        QStringLiteral("bangongxuexi"),
+        QStringLiteral("yuedufanyi"),
+        QStringLiteral("bianchengkaifai"),
+        QStringLiteral("xitongguanli"),
+        QStringLiteral("qita"),
     };
-    return ty2py.find(ty) != ty2py.end() ? ty2py[ty] : "qita";
+    static_assert(sizeof(ty2py) / sizeof(ty2py[0]) == int(Categorytype::CategoryErr), "missing category pinyin");
+
+    const int index = int(ty);
+    return index >= 0 && index < int(Categorytype::CategoryErr) ? ty2py[index] : ty2py[int(Categorytype::CategoryOthers)];
 }
 
-Categorytype Category::parseCategoryString(QString str) {
-    QMap<QString, Categorytype> name2ty {
-        {"internet", Categorytype::CategoryInternet},
-        {"chat", Categorytype::CategoryChat},
-        {"music", Categorytype::CategoryMusic},
-        {"video", Categorytype::CategoryVideo},
-        {"graphics", Categorytype::CategoryGraphics},
-        {"office", Categorytype::CategoryOffice},
-        {"game", Categorytype::CategoryGame},
-        {"reading", Categorytype::CategoryReading},
-        {"development", Categorytype::CategoryDevelopment},
-        {"system", Categorytype::CategorySystem},
-        {"others", Categorytype::CategoryOthers},
-    };
-    return name2ty.find(str) != name2ty.end() ? name2ty[str] : Categorytype::CategoryErr;
+Categorytype Category::parseCategoryString(const QString &str) {
+    const CategoryName *name = findName(CategoryTable, CategoryNames, str);
+    return name ? name->type : Categorytype::CategoryErr;
 }
 
-QList<Categorytype> Category::parseXCategoryString(QString str) {
-    QMultiMap<QString, Categorytype> xname2ty {
-        {"2dgraphics",                      Categorytype::CategoryGraphics},
-        {"3dgraphics",                      Categorytype::CategoryGraphics},
-        {"accessibility",                   Categorytype::CategorySystem},
-        {"accessories",                     Categorytype::CategoryOthers},
-        {"actiongame",                      Categorytype::CategoryGame},
-        {"advancedsettings",                Categorytype::CategorySystem},
-        {"adventuregame",                   Categorytype::CategoryGame},
-        {"amusement",                       Categorytype::CategoryGame},
-        {"applet",                          Categorytype::CategoryOthers},
-        {"arcadegame",                      Categorytype::CategoryGame},
-        {"archiving",                       Categorytype::CategorySystem},
-        {"art",                             Categorytype::CategoryOffice},
-        {"artificialintelligence",          Categorytype::CategoryOffice},
-        {"astronomy",                       Categorytype::CategoryOffice},
-        {"audio",                           Categorytype::CategoryMusic},
-        {"audiovideo",                      Categorytype::CategoryMusic},
-        {"audiovideo",                      Categorytype::CategoryVideo},
-        {"audiovideoediting",               Categorytype::CategoryMusic},
-        {"audiovideoediting",               Categorytype::CategoryVideo},
-        {"biology",                         Categorytype::CategoryOffice},
-        {"blocksgame",                      Categorytype::CategoryGame},
-        {"boardgame",                       Categorytype::CategoryGame},
-        {"building",                        Categorytype::CategoryDevelopment},
-        {"calculator",                      Categorytype::CategorySystem},
-        {"calendar",                        Categorytype::CategorySystem},
-        {"cardgame",                        Categorytype::CategoryGame},
-        {"cd",                              Categorytype::CategoryMusic},
-        {"chart",                           Categorytype::CategoryOffice},
-        {"chat",                            Categorytype::CategoryChat},
-        {"chemistry",                       Categorytype::CategoryOffice},
-        {"clock",                           Categorytype::CategorySystem},
-        {"compiz",                          Categorytype::CategorySystem},
-        {"compression",                     Categorytype::CategorySystem},
-        {"computerscience",                 Categorytype::CategoryOffice},
-        {"consoleonly",                     Categorytype::CategoryOthers},
-        {"contactmanagement",               Categorytype::CategoryChat},
-        {"core",                            Categorytype::CategoryOthers},
-        {"debugger",                        Categorytype::CategoryDevelopment},
-        {"desktopsettings",                 Categorytype::CategorySystem},
-        {"desktoputility",                  Categorytype::CategorySystem},
-        {"development",                     Categorytype::CategoryDevelopment},
-        {"dialup",                          Categorytype::CategorySystem},
-        {"dictionary",                      Categorytype::CategoryOffice},
-        {"discburning",                     Categorytype::CategorySystem},
-        {"documentation",                   Categorytype::CategoryOffice},
-        {"editors",                         Categorytype::CategoryOthers},
-        {"education",                       Categorytype::CategoryOffice},
-        {"electricity",                     Categorytype::CategoryOffice},
-        {"electronics",                     Categorytype::CategoryOffice},
-        {"email",                           Categorytype::CategoryInternet},
-        {"emulator",                        Categorytype::CategoryGame},
-        {"engineering",                     Categorytype::CategorySystem},
-        {"favorites",                       Categorytype::CategoryOthers},
-        {"filemanager",                     Categorytype::CategorySystem},
-        {"filesystem",                      Categorytype::CategorySystem},
-        {"filetools",                       Categorytype::CategorySystem},
-        {"filetransfer",                    Categorytype::CategoryInternet},
-        {"finance",                         Categorytype::CategoryOffice},
-        {"game",                            Categorytype::CategoryGame},
-        {"geography",                       Categorytype::CategoryOffice},
-        {"geology",                         Categorytype::CategoryOffice},
-        {"geoscience",                      Categorytype::CategoryOthers},
-        {"gnome",                           Categorytype::CategorySystem},
-        {"gpe",                             Categorytype::CategoryOthers},
-        {"graphics",                        Categorytype::CategoryGraphics},
-        {"guidesigner",                     Categorytype::CategoryDevelopment},
-        {"hamradio",                        Categorytype::CategoryOffice},
-        {"hardwaresettings",                Categorytype::CategorySystem},
-        {"ide",                             Categorytype::CategoryDevelopment},
-        {"imageprocessing",                 Categorytype::CategoryGraphics},
-        {"instantmessaging",                Categorytype::CategoryChat},
-        {"internet",                        Categorytype::CategoryInternet},
-        {"ircclient",                       Categorytype::CategoryChat},
-        {"kde",                             Categorytype::CategorySystem},
-        {"kidsgame",                        Categorytype::CategoryGame},
-        {"literature",                      Categorytype::CategoryOffice},
-        {"logicgame",                       Categorytype::CategoryGame},
-        {"math",                            Categorytype::CategoryOffice},
-        {"medicalsoftware",                 Categorytype::CategoryOffice},
-        {"meteorology",                     Categorytype::CategoryOthers},
-        {"midi",                            Categorytype::CategoryMusic},
-        {"mixer",                           Categorytype::CategoryMusic},
-        {"monitor",                         Categorytype::CategorySystem},
-        {"motif",                           Categorytype::CategoryOthers},
-        {"multimedia",                      Categorytype::CategoryVideo},
-        {"music",                           Categorytype::CategoryMusic},
-        {"network",                         Categorytype::CategoryInternet},
-        {"news",                            Categorytype::CategoryReading},
-        {"numericalanalysis",               Categorytype::CategoryOffice},
-        {"ocr",                             Categorytype::CategoryGraphics},
-        {"office",                          Categorytype::CategoryOffice},
-        {"p2p",                             Categorytype::CategoryInternet},
-        {"packagemanager",                  Categorytype::CategorySystem},
-        {"panel",                           Categorytype::CategorySystem},
-        {"pda",                             Categorytype::CategorySystem},
-        {"photography",                     Categorytype::CategoryGraphics},
-        {"physics",                         Categorytype::CategoryOffice},
-        {"pim",                             Categorytype::CategoryOthers},
-        {"player",                          Categorytype::CategoryMusic},
-        {"player",                          Categorytype::CategoryVideo},
-        {"playonlinux",                     Categorytype::CategoryOthers},
-        {"presentation",                    Categorytype::CategoryOffice},
-        {"printing",                        Categorytype::CategoryOffice},
-        {"profiling",                       Categorytype::CategoryDevelopment},
-        {"projectmanagement",               Categorytype::CategoryOffice},
-        {"publishing",                      Categorytype::CategoryOffice},
-        {"puzzlegame",                      Categorytype::CategoryGame},
-        {"rastergraphics",                  Categorytype::CategoryGraphics},
-        {"recorder",                        Categorytype::CategoryMusic},
-        {"recorder",                        Categorytype::CategoryVideo},
-        {"remoteaccess",                    Categorytype::CategorySystem},
-        {"revisioncontrol",                 Categorytype::CategoryDevelopment},
-        {"robotics",                        Categorytype::CategoryOffice},
-        {"roleplaying",                     Categorytype::CategoryGame},
-        {"scanning",                        Categorytype::CategoryOffice},
-        {"science",                         Categorytype::CategoryOffice},
-        {"screensaver",                     Categorytype::CategoryOthers},
-        {"sequencer",                       Categorytype::CategoryMusic},
-        {"settings",                        Categorytype::CategorySystem},
-        {"security",                        Categorytype::CategorySystem},
-        {"simulation",                      Categorytype::CategoryGame},
-        {"sportsgame",                      Categorytype::CategoryGame},
-        {"spreadsheet",                     Categorytype::CategoryOffice},
-        {"strategygame",                    Categorytype::CategoryGame},
-        {"system",                          Categorytype::CategorySystem},
-        {"systemsettings",                  Categorytype::CategorySystem},
-        {"technical",                       Categorytype::CategoryOthers},
-        {"telephony",                       Categorytype::CategorySystem},
-        {"telephonytools",                  Categorytype::CategorySystem},
-        {"terminalemulator",                Categorytype::CategorySystem},
-        {"texteditor",                      Categorytype::CategoryOffice},
-        {"texttools",                       Categorytype::CategoryOffice},
-        {"transiation",                     Categorytype::CategoryDevelopment},
-        {"translation",                     Categorytype::CategoryReading},
-        {"trayicon",                        Categorytype::CategorySystem},
-        {"tuner",                           Categorytype::CategoryMusic},
-        {"tv",                              Categorytype::CategoryVideo},
-        {"utility",                         Categorytype::CategorySystem},
-        {"vectorgraphics",                  Categorytype::CategoryGraphics},
-        {"video",                           Categorytype::CategoryVideo},
-        {"videoconference",                 Categorytype::CategoryInternet},
-        {"viewer",                          Categorytype::CategoryGraphics},
-        {"webbrowser",                      Categorytype::CategoryInternet},
-        {"webdevelopment",                  Categorytype::CategoryDevelopment},
-        {"wine",                            Categorytype::CategoryOthers},
-        {"wine-programs-accessories",       Categorytype::CategoryOthers},
-        {"wordprocessor",                   Categorytype::CategoryOffice},
-        {"x-alsa",                          Categorytype::CategoryMusic},
-        {"x-bible",                         Categorytype::CategoryReading},
-        {"x-bluetooth",                     Categorytype::CategorySystem},
-        {"x-debian-applications-emulators", Categorytype::CategoryGame},
-        {"x-digital_processing",            Categorytype::CategorySystem},
-        {"x-enlightenment",                 Categorytype::CategorySystem},
-        {"x-geeqie",                        Categorytype::CategoryGraphics},
-        {"x-gnome-networksettings",         Categorytype::CategorySystem},
-        {"x-gnome-personalsettings",        Categorytype::CategorySystem},
-        {"x-gnome-settings-panel",          Categorytype::CategorySystem},
-        {"x-gnome-systemsettings",          Categorytype::CategorySystem},
-        {"x-gnustep",                       Categorytype::CategorySystem},
-        {"x-islamic-software",              Categorytype::CategoryReading},
-        {"x-jack",                          Categorytype::CategoryMusic},
-        {"x-kde-edu-misc",                  Categorytype::CategoryReading},
-        {"x-kde-internet",                  Categorytype::CategorySystem},
-        {"x-kde-more",                      Categorytype::CategorySystem},
-        {"x-kde-utilities-desktop",         Categorytype::CategorySystem},
-        {"x-kde-utilities-file",            Categorytype::CategorySystem},
-        {"x-kde-utilities-peripherals",     Categorytype::CategorySystem},
-        {"x-kde-utilities-pim",             Categorytype::CategorySystem},
-        {"x-lxde-settings",                 Categorytype::CategorySystem},
-        {"x-mandriva-office-publishing",    Categorytype::CategoryOthers},
-        {"x-mandrivalinux-internet-other",  Categorytype::CategorySystem},
-        {"x-mandrivalinux-office-other",    Categorytype::CategoryOffice},
-        {"x-mandrivalinux-system-archiving-backup", Categorytype::CategorySystem},
-        {"x-midi",                           Categorytype::CategoryMusic},
-        {"x-misc",                           Categorytype::CategorySystem},
-        {"x-multitrack",                     Categorytype::CategoryMusic},
-        {"x-novell-main",                    Categorytype::CategorySystem},
-        {"x-quran",                          Categorytype::CategoryReading},
-        {"x-red-hat-base",                   Categorytype::CategorySystem},
-        {"x-red-hat-base-only",              Categorytype::CategorySystem},
-        {"x-red-hat-extra",                  Categorytype::CategorySystem},
-        {"x-red-hat-serverconfig",           Categorytype::CategorySystem},
-        {"x-religion",                       Categorytype::CategoryReading},
-        {"x-sequencers",                     Categorytype::CategoryMusic},
-        {"x-sound",                          Categorytype::CategoryMusic},
-        {"x-sun-supported",                  Categorytype::CategorySystem},
-        {"x-suse-backup",                    Categorytype::CategorySystem},
-        {"x-suse-controlcenter-lookandfeel", Categorytype::CategorySystem},
-        {"x-suse-controlcenter-system",      Categorytype::CategorySystem},
-        {"x-suse-core",                      Categorytype::CategorySystem},
-        {"x-suse-core-game",                 Categorytype::CategoryGame},
-        {"x-suse-core-office",               Categorytype::CategoryOffice},
-        {"x-suse-sequencer",                 Categorytype::CategoryMusic},
-        {"x-suse-yast",                      Categorytype::CategorySystem},
-        {"x-suse-yast-high_availability",    Categorytype::CategorySystem},
-        {"x-synthesis",                      Categorytype::CategorySystem},
-        {"x-turbolinux-office",              Categorytype::CategoryOffice},
-        {"x-xfce",                           Categorytype::CategorySystem},
-        {"x-xfce-toplevel",                  Categorytype::CategorySystem},
-        {"x-xfcesettingsdialog",             Categorytype::CategorySystem},
-        {"x-ximian-main",                    Categorytype::CategorySystem},
-    };
+QList<Categorytype> Category::parseXCategoryString(const QString &str) {
+    Categorytype types[MaxXCategoryTypes];
+    QList<Categorytype> ret;
+    for (int i = 0, count = parseXCategoryString(str, types); i < count; ++i)
+        ret.push_back(types[i]);
+
+    return ret;
+}
+
+int Category::parseXCategoryString(const QString &str, Categorytype (&types)[MaxXCategoryTypes]) {
+    const CategoryName *name = findName(XCategoryTable, XCategoryNames, str);
+    if (!name)
+        return 0;
+
+    types[0] = name->type;
+    if (name->extra == Categorytype::CategoryErr)
+        return 1;
 
-    return {xname2ty.values(str)};
+    types[1] = name->extra;
+    return 2;
 }
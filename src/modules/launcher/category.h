@@ -8,7 +8,7 @@
 #include "common.h"
 
 #include <QString>
-#include <QMultiMap>
+#include <QList>
 
 // 应用类型
 enum class Categorytype {
@@ -36,10 +36,15 @@ public:
     static QString getStr(Categorytype ty);
     // 类型转拼音
     static QString pinYin(Categorytype ty);
-    // 字符串转类型
-    static Categorytype parseCategoryString(QString str);
-    // Xorg类型字符串转类型列表
-    static QList<Categorytype> parseXCategoryString(QString str);
+    // 一个Xorg类型最多对应的类型数
+    static constexpr int MaxXCategoryTypes = 2;
+
+    // 字符串转类型，忽略大小写
+    static Categorytype parseCategoryString(const QString &str);
+    // Xorg类型字符串转类型列表，忽略大小写
+    static QList<Categorytype> parseXCategoryString(const QString &str);
+    // 同上，结果写入types，返回类型个数，不分配内存
+    static int parseXCategoryString(const QString &str, Categorytype (&types)[MaxXCategoryTypes]);
 };
 
 #endif // CATEGORY_H
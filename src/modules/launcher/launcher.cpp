@@ -38,6 +38,12 @@ const QString LASTORE_SERVICE = "org.deepin.dde.Lastore1";
 const QString LASTORE_PATH = "/org/deepin/dde/Lastore1";
 const QString LASTORE_INTERFACE = "org.deepin.dde.Lastore1.Manager";
 
+// 查询以StringPool句柄为键的容器，只查找不插入，未知的字符串返回无效句柄
+static inline StringPool::Handle poolKey(const QString &str)
+{
+    return StringPool::instance()->find(str);
+}
+
 Launcher::Launcher(QObject *parent)
     : SynModule(parent)
     , m_appInfo(DesktopInfo(""))
@@ -84,7 +90,7 @@ QByteArray Launcher::getSyncConfig()
     return doc.toJson();
 }
 
-const QMap<QString, Item> *Launcher::getItems()
+const QHash<StringPool::Handle, Item> *Launcher::getItems()
 {
     return &itemsMap;
 }
@@ -154,7 +160,7 @@ QStringList Launcher::getAllNewInstalledApps()
  */
 bool Launcher::getDisableScaling(QString appId)
 {
-    if (itemsMap.find(appId) == itemsMap.end())
+    if (itemsMap.find(poolKey(appId)) == itemsMap.end())
         return false;
 
     for (const auto &app : SETTING->getDisableScalingApps()) {
@@ -172,10 +178,10 @@ bool Launcher::getDisableScaling(QString appId)
 LauncherItemInfo Launcher::getItemInfo(QString appId)
 {
     LauncherItemInfo info;
-    if (itemsMap.find(appId) == itemsMap.end())
+    if (itemsMap.find(poolKey(appId)) == itemsMap.end())
         return info;
 
-    info = itemsMap[appId].info;
+    info = itemsMap[poolKey(appId)].info;
     return info;
 }
 
@@ -186,7 +192,7 @@ LauncherItemInfo Launcher::getItemInfo(QString appId)
  */
 bool Launcher::getUseProxy(QString appId)
 {
-    if (itemsMap.find(appId) == itemsMap.end())
+    if (itemsMap.find(poolKey(appId)) == itemsMap.end())
         return false;
 
     for (const auto &app : SETTING->getUseProxyApps()) {
@@ -203,7 +209,7 @@ bool Launcher::getUseProxy(QString appId)
  */
 bool Launcher::isItemOnDesktop(QString appId)
 {
-    if (itemsMap.find(appId) == itemsMap.end())
+    if (itemsMap.find(poolKey(appId)) == itemsMap.end())
         return  false;
 
     QString filePath(QDir::homePath() + "/Desktop/" + appId + ".desktop");
@@ -218,7 +224,7 @@ bool Launcher::isItemOnDesktop(QString appId)
  */
 bool Launcher::requestRemoveFromDesktop(QString appId)
 {
-    if (itemsMap.find(appId) == itemsMap.end())
+    if (itemsMap.find(poolKey(appId)) == itemsMap.end())
         return false;
 
     QString filePath(QDir::homePath() + "/Desktop/" + appId + ".desktop");
@@ -237,7 +243,7 @@ bool Launcher::requestRemoveFromDesktop(QString appId)
  */
 bool Launcher::requestSendToDesktop(QString appId)
 {
-    if (itemsMap.find(appId) == itemsMap.end())
+    if (itemsMap.find(poolKey(appId)) == itemsMap.end())
         return false;
 
     QString filePath(QDir::homePath() + "/Desktop/" + appId + ".desktop");
@@ -246,7 +252,7 @@ bool Launcher::requestSendToDesktop(QString appId)
         return false;
 
     // 创建桌面快捷方式文件
-    DesktopInfo dinfo(itemsMap[appId].info.path.toStdString());
+    DesktopInfo dinfo(itemsMap[poolKey(appId)].info.path.toStdString());
     dinfo.getDesktopFile()->setKey(MainSection, "X-Deepin-CreatedBy", dbusService.toStdString());
     dinfo.getDesktopFile()->setKey(MainSection, "X-Deepin-AppID", appId.toStdString());
     if (!dinfo.getDesktopFile()->saveToFile(filePath.toStdString()))
@@ -321,7 +327,7 @@ void Launcher::requestUninstall(const QString &desktop)
  */
 void Launcher::setDisableScaling(QString appId, bool value)
 {
-    if (itemsMap.find(appId) == itemsMap.end())
+    if (itemsMap.find(poolKey(appId)) == itemsMap.end())
         return;
 
     QVector<QString> apps = SETTING->getDisableScalingApps();
@@ -355,7 +361,7 @@ void Launcher::setDisableScaling(QString appId, bool value)
  */
 void Launcher::setUseProxy(QString appId, bool value)
 {
-    if (itemsMap.find(appId) == itemsMap.end())
+    if (itemsMap.find(poolKey(appId)) == itemsMap.end())
         return;
 
 
@@ -406,7 +412,7 @@ void Launcher::handleFSWatcherEvents(QDBusMessage msg)
             if (pkg.isEmpty())
                 continue;
 
-            Item &item = itemsMap[id];
+            Item &item = itemsMap[poolKey(id)];
             Categorytype ty = queryCategoryId(&item);
             if (qint64(ty) != item.info.categoryId) {
                 item.info.categoryId = qint64(ty);
@@ -486,7 +492,7 @@ void Launcher::loadDesktopPkgMap()
         if (appId == "")
             continue;
 
-        desktopPkgMap[appId] = iter.value().toString();
+        desktopPkgMap[StringPool::instance()->intern(appId)] = StringPool::instance()->internString(iter.value().toString());
     }
 }
 
@@ -514,7 +520,7 @@ void Launcher::loadPkgCategoryMap()
         QJsonObject infoObj = iter.value().toJsonObject();
         QVariantMap infoMap = infoObj.toVariantMap();
         QString category = infoMap["category"].toString();
-        pkgCategoryMap[iter.key()] = Category::parseCategoryString(category);
+        pkgCategoryMap[StringPool::instance()->intern(iter.key())] = Category::parseCategoryString(category);
     }
 }
 
@@ -604,19 +610,19 @@ void Launcher::handleAppHiddenChanged()
 
     // 处理新增隐藏应用
     for (const auto &app : newSet - oldSet) {
-        if (itemsMap.find(app) == itemsMap.end())
+        if (itemsMap.find(poolKey(app)) == itemsMap.end())
             continue;
 
-        emitItemChanged(&itemsMap[app], appStatusDeleted);
-        itemsMap.remove(app);
+        emitItemChanged(&itemsMap[poolKey(app)], appStatusDeleted);
+        itemsMap.remove(poolKey(app));
     }
 
     // 处理显示应用
     for (const auto &appId : oldSet - newSet) {
-        if (itemsMap.find(appId) == itemsMap.end())
+        if (itemsMap.find(poolKey(appId)) == itemsMap.end())
             continue;
 
-        DesktopInfo info = DesktopInfo(itemsMap[appId].info.path.toStdString());
+        DesktopInfo info = DesktopInfo(itemsMap[poolKey(appId)].info.path.toStdString());
         if (!info.isValidDesktop()) {
             qWarning() << "invalid Desktop Path";
             continue;
@@ -672,7 +678,7 @@ void Launcher::loadNameMap()
             if (infoIter.value().toJsonValue().isObject())
                 continue;
 
-            nameMap[infoIter.key()] = infoIter.value().toString();
+            nameMap[StringPool::instance()->intern(infoIter.key())] = infoIter.value().toString();
         }
     }
 }
@@ -708,14 +714,15 @@ void Launcher::addItem(Item &item)
         return;
     }
 
-    if (nameMap.size() > 0 && nameMap.find(item.info.id) != nameMap.end()) {
-        QString name = nameMap[item.info.id];
+    auto nameIter = nameMap.constFind(poolKey(item.info.id));
+    if (nameIter != nameMap.constEnd()) {
+        QString name = nameIter.value();
         if (!name.isEmpty())
             item.info.name = name;
     }
 
     item.info.categoryId = qint64(queryCategoryId(&item));
-    itemsMap[item.info.id] = item;
+    itemsMap[StringPool::instance()->intern(item.info.id)] = item;
 
     QFileInfo desktopInfo(item.info.path);
     m_desktopAndItemMap[item.info.path] = item;
@@ -727,8 +734,9 @@ Categorytype Launcher::queryCategoryId(const Item *item)
     if (pkg.isEmpty()) {
         noPkgItemIds[item->info.id] = 1;
 
-        if (pkgCategoryMap.find(pkg) != pkgCategoryMap.end())
-            return pkgCategoryMap[pkg];
+        auto iter = pkgCategoryMap.constFind(poolKey(pkg));
+        if (iter != pkgCategoryMap.constEnd())
+            return iter.value();
     }
 
     Categorytype category = Category::parseCategoryString(item->xDeepinCategory);
@@ -745,61 +753,40 @@ Categorytype Launcher::queryCategoryId(const Item *item)
  */
 Categorytype Launcher::getXCategory(const Item *item)
 {
-    // 统计应用类型
-    QMap<Categorytype, int> categoriesMap;
+    // 统计应用类型，类型查找忽略大小写且不分配内存
+    int counts[int(Categorytype::CategoryErr)] {};
     for (const auto &category : item->categories) {
-        QString lCategory = category.toLower();
-        QList<Categorytype> tys;
-        Categorytype ty = Category::parseCategoryString(lCategory);
-        if (ty != Categorytype::CategoryErr)
-            tys.push_back(ty);
-        else if (Category::parseXCategoryString(lCategory).size() > 0) {
-            tys.append(Category::parseXCategoryString(lCategory));
+        Categorytype ty = Category::parseCategoryString(category);
+        if (ty != Categorytype::CategoryErr) {
+            counts[int(ty)]++;
+            continue;
         }
 
-        for (const auto & ty : tys)
-            categoriesMap[ty]++;
+        Categorytype tys[Category::MaxXCategoryTypes];
+        for (int i = 0, count = Category::parseXCategoryString(category, tys); i < count; ++i)
+            counts[int(tys[i])]++;
     }
 
-    categoriesMap.remove(Categorytype::CategoryOthers);
-    if (categoriesMap.size() == 0)
-        return Categorytype::CategoryOthers;
+    counts[int(Categorytype::CategoryOthers)] = 0;
 
-    // 计算最多的类型
+    // 计算最多的类型，数量相同时取枚举值较小的
     int max = 0;
     Categorytype ty {Categorytype::CategoryOthers};
-    for (auto iter = categoriesMap.begin(); iter != categoriesMap.end(); iter++) {
-        if (iter.value() > max) {
-            max = iter.value();
-            ty = iter.key();
+    for (int i = 0; i < int(Categorytype::CategoryErr); i++) {
+        if (counts[i] > max) {
+            max = counts[i];
+            ty = Categorytype(i);
         }
     }
 
-    QList<Categorytype> maxCatogories {ty};
-    for (auto iter = categoriesMap.begin(); iter != categoriesMap.end(); iter++) {
-        if (iter.key() != ty && iter.value() == max) {
-            maxCatogories.push_back(iter.key());
-        }
-    }
-
-    if (maxCatogories.size() == 1)
-        return maxCatogories[0];
-
-    std::sort(maxCatogories.begin(), maxCatogories.end());
-
-    // 检查是否同时存在音乐和视频播放器
-    QPair<bool, bool> found;
-    for (auto iter = maxCatogories.begin(); iter != maxCatogories.end(); iter++) {
-        if (*iter == Categorytype::CategoryMusic)
-            found.first = true;
-        else if (*iter == Categorytype::CategoryVideo)
-            found.second = true;
-    }
+    if (max == 0)
+        return Categorytype::CategoryOthers;
 
-    if (found.first && found.second)
+    // 同时存在音乐和视频播放器
+    if (counts[int(Categorytype::CategoryMusic)] == max && counts[int(Categorytype::CategoryVideo)] == max)
         return Categorytype::CategoryVideo;
 
-    return maxCatogories[0];
+    return ty;
 }
 
 /**
@@ -875,8 +862,9 @@ QString Launcher::queryPkgName(const QString &itemID, const QString &itemPath)
     if (DString::startWith(itemID.toStdString(), "org.deepin.flatdeb."))
         return QString("deepin-fpapp-") + itemID;
 
-    if (desktopPkgMap.find(itemID) != desktopPkgMap.end())
-        return desktopPkgMap[itemID];
+    auto iter = desktopPkgMap.constFind(poolKey(itemID));
+    if (iter != desktopPkgMap.constEnd())
+        return iter.value();
 
     return QString();
 }
@@ -889,11 +877,11 @@ QString Launcher::queryPkgName(const QString &itemID, const QString &itemPath)
 Item Launcher::getItemByPath(QString itemPath)
 {
     QString appId = getAppIdByFilePath(itemPath, appDirs);
-    if (itemsMap.find(appId) == itemsMap.end())
+    if (itemsMap.find(poolKey(appId)) == itemsMap.end())
         return Item();
 
-    if (itemsMap[appId].info.path == itemPath)
-        return itemsMap[appId];
+    if (itemsMap[poolKey(appId)].info.path == itemPath)
+        return itemsMap[poolKey(appId)];
 
     return Item();
 }
@@ -1196,9 +1184,10 @@ Item Launcher::NewItemWithDesktopInfo(DesktopInfo &info)
     QString xDeepinCategory(info.getDesktopFile()->getStr(MainSection, "X-Deepin-Category").c_str());
     QString xDeepinVendor(info.getDesktopFile()->getStr(MainSection, "X-Deepin-Vendor").c_str());
 
+    QString genericName(info.getGenericName().c_str());
     QString appName;
     if (xDeepinVendor == "deepin")
-        appName = info.getGenericName().c_str();
+        appName = genericName;
 
     if (appName.isEmpty())
         appName = info.getName().c_str();
@@ -1214,10 +1203,10 @@ Item Launcher::NewItemWithDesktopInfo(DesktopInfo &info)
     item.info.path = appFileName;
     item.info.name = appName;
     item.info.keywords << enName << appName;
-    item.info.id = getAppIdByFilePath(item.info.path, appDirs);
+    item.info.id = StringPool::instance()->internString(getAppIdByFilePath(item.info.path, appDirs));
     item.info.timeInstalled = ctime;
     item.exec = info.getCommandLine().c_str();
-    item.genericName = info.getGenericName().c_str();
+    item.genericName = genericName;
     item.comment = enComment;
     if (!info.getIcon().empty()) {
         item.info.icon = info.getIcon().c_str();
@@ -1229,8 +1218,10 @@ Item Launcher::NewItemWithDesktopInfo(DesktopInfo &info)
         item.desktopKeywords.push_back(QString(keyWord.c_str()).toLower());
     }
 
+    // 分类名在各应用间大量重复，小写形式由字符串池缓存
+    StringPool *pool = StringPool::instance();
     for (auto &category : info.getCategories()) {
-        item.categories.push_back(QString(category.c_str()).toLower());
+        item.categories.push_back(pool->string(pool->lower(pool->intern(QString(category.c_str())))));
     }
     return item;
 }
@@ -10,8 +10,10 @@
 #include "category.h"
 #include "launcheriteminfolist.h"
 #include "desktopinfo.h"
+#include "stringpool.h"
 
 #include <QObject>
+#include <QHash>
 #include <QMap>
 #include <QVector>
 #include <QDBusMessage>
@@ -71,7 +73,7 @@ public:
     QByteArray getSyncConfig();
 
     void initItems();
-    const QMap<QString, Item> *getItems();
+    const QHash<StringPool::Handle, Item> *getItems();
 
     int getDisplayMode();
     bool getFullScreen();
@@ -135,10 +137,11 @@ private:
     void removeAutoStart(const QString &desktop);
 
 private:
-    QMap<QString, Item> itemsMap;                                   // appId, Item
-    QMap<QString, QString> desktopPkgMap;
-    QMap<QString, Categorytype> pkgCategoryMap;
-    QMap<QString, QString> nameMap;                                 // appId, Name
+    // 以下容器的键均为StringPool句柄
+    QHash<StringPool::Handle, Item> itemsMap;                       // appId, Item
+    QHash<StringPool::Handle, QString> desktopPkgMap;               // appId, pkg
+    QHash<StringPool::Handle, Categorytype> pkgCategoryMap;         // pkg, category
+    QHash<StringPool::Handle, QString> nameMap;                     // appId, Name
     QMap<QString, int> noPkgItemIds;
     QVector<QString> appsHidden;
 
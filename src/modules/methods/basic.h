@@ -15,21 +15,23 @@ namespace Methods
 		QString type;
 	};
 
-	inline void fromJson(const QByteArray &array, Basic &basic)
+	inline bool fromJson(const QByteArray &array, Basic &basic)
 	{
 		QJsonDocument doc = QJsonDocument::fromJson(array);
 		if (!doc.isObject()) {
 			qWarning() << "fromJson basic failed";
-			return;
+			return false;
 		}
 
 		QJsonObject obj = doc.object();
 		if (!obj.contains("type")) {
 			qWarning() << "type not exist in basic array";
-			return;
+			return false;
 		}
 
 		basic.type = obj.value("type").toString();
+
+		return true;
 	}
 
 } // namespace Methods
@@ -5,6 +5,8 @@
 #ifndef C664E26D_6517_412B_950F_07E20963349E
 #define C664E26D_6517_412B_950F_07E20963349E
 
+#include "wire.h"
+
 #include <QDebug>
 #include <QJsonObject>
 #include <QJsonDocument>
@@ -21,23 +23,39 @@ inline void toJson(QByteArray &array, const Instance &instance) {
         { "hash", instance.hash }
     };
 
-    array = QJsonDocument(obj).toJson();
+    array = QJsonDocument(obj).toJson(QJsonDocument::Compact);
 }
 
-inline void fromJson(const QByteArray &array, Instance &instance) {
+inline bool fromJson(const QByteArray &array, Instance &instance) {
     QJsonDocument doc = QJsonDocument::fromJson(array);
     if (!doc.isObject()) {
         qWarning() << "fromJson instance failed";
-        return;
+        return false;
     }
 
     QJsonObject obj = doc.object();
     if (!obj.contains("hash")) {
         qWarning() << "hash not exist in instance array";
-        return;
+        return false;
     }
 
     instance.hash = obj.value("hash").toString();
+
+    return true;
+}
+
+inline void toWire(Wire::Writer &writer, const Instance &instance) {
+    writer.add(Wire::TagType, instance.type);
+    writer.add(Wire::TagHash, instance.hash);
+}
+
+inline bool fromWire(Wire::Reader &reader, Instance &instance) {
+    while (reader.next()) {
+        if (reader.tag() == Wire::TagHash)
+            instance.hash = reader.string();
+    }
+
+    return reader.atEnd();
 }
 
 }  // namespace Methods
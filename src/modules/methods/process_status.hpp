@@ -5,6 +5,8 @@
 #ifndef PROCESS_STATUS_H_
 #define PROCESS_STATUS_H_
 
+#include "wire.h"
+
 #include <QDebug>
 #include <QJsonObject>
 #include <QJsonDocument>
@@ -26,26 +28,51 @@ inline void toJson(QByteArray& array, const ProcessStatus& processStatus)
         { "code", processStatus.code }
     };
 
-    array = QJsonDocument(obj).toJson();
+    array = QJsonDocument(obj).toJson(QJsonDocument::Compact);
 }
-inline void fromJson(const QByteArray& array, ProcessStatus& quit)
+inline bool fromJson(const QByteArray& array, ProcessStatus& quit)
 {
     QJsonDocument doc = QJsonDocument::fromJson(array);
     if (!doc.isObject()) {
         qWarning() << "fromJson quit failed";
-        return;
+        return false;
     }
 
     QJsonObject obj = doc.object();
     if (!obj.contains("id") || !obj.contains("data") || !obj.contains("code")) {
         qWarning() << "id data code not exist in quit array";
-        return;
+        return false;
     }
 
     quit.id = obj.value("id").toString();
     quit.data = obj.value("data").toString();
     quit.code = obj.value("code").toInt();
     quit.type = obj.value("type").toString();
+
+    return true;
+}
+
+inline void toWire(Wire::Writer &writer, const ProcessStatus &processStatus)
+{
+    writer.add(Wire::TagType, processStatus.type);
+    writer.add(Wire::TagData, processStatus.data);
+    writer.add(Wire::TagId, processStatus.id);
+    writer.add(Wire::TagCode, int64_t(processStatus.code));
+}
+
+inline bool fromWire(Wire::Reader &reader, ProcessStatus &processStatus)
+{
+    while (reader.next()) {
+        switch (reader.tag()) {
+        case Wire::TagType: processStatus.type = reader.string(); break;
+        case Wire::TagData: processStatus.data = reader.string(); break;
+        case Wire::TagId: processStatus.id = reader.string(); break;
+        case Wire::TagCode: processStatus.code = int(reader.integer()); break;
+        default: break;
+        }
+    }
+
+    return reader.atEnd();
 }
 }  // namespace Methods
 
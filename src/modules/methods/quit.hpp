@@ -4,6 +4,8 @@
 
 #ifndef QUIT_H_
 #define QUIT_H_
+#include "wire.h"
+
 #include <QDebug>
 #include <QJsonObject>
 #include <QJsonDocument>
@@ -24,25 +26,47 @@ inline void toJson(QByteArray &array, const Quit &quit) {
         { "code", quit.code }
     };
 
-    array = QJsonDocument(obj).toJson();
+    array = QJsonDocument(obj).toJson(QJsonDocument::Compact);
 }
 
-inline void fromJson(const QByteArray &array, Quit &quit) {
+inline bool fromJson(const QByteArray &array, Quit &quit) {
     QJsonDocument doc = QJsonDocument::fromJson(array);
     if (!doc.isObject()) {
         qWarning() << "fromJson quit failed";
-        return;
+        return false;
     }
 
     QJsonObject obj = doc.object();
     if (!obj.contains("id") || !obj.contains("date") || !obj.contains("code")) {
         qWarning() << "id date code not exist in quit array";
-        return;
+        return false;
     }
 
     quit.id = obj.value("id").toString();
     quit.date = obj.value("date").toString();
     quit.code = obj.value("code").toInt();
+
+    return true;
+}
+
+inline void toWire(Wire::Writer &writer, const Quit &quit) {
+    writer.add(Wire::TagType, quit.type);
+    writer.add(Wire::TagDate, quit.date);
+    writer.add(Wire::TagId, quit.id);
+    writer.add(Wire::TagCode, int64_t(quit.code));
+}
+
+inline bool fromWire(Wire::Reader &reader, Quit &quit) {
+    while (reader.next()) {
+        switch (reader.tag()) {
+        case Wire::TagDate: quit.date = reader.string(); break;
+        case Wire::TagId: quit.id = reader.string(); break;
+        case Wire::TagCode: quit.code = int(reader.integer()); break;
+        default: break;
+        }
+    }
+
+    return reader.atEnd();
 }
 
 }  // namespace Methods
@@ -4,6 +4,8 @@
 
 #ifndef REGISTER_H_
 #define REGISTER_H_
+#include "wire.h"
+
 #include <QJsonObject>
 #include <QJsonDocument>
 #include <QDebug>
@@ -26,27 +28,52 @@ inline void toJson(QByteArray &array, const Registe &registe) {
         { "date", registe.date }
     };
 
-    array = QJsonDocument(obj).toJson();
+    array = QJsonDocument(obj).toJson(QJsonDocument::Compact);
 }
 
-inline void fromJson(const QByteArray &array, Registe &registe) {
+inline bool fromJson(const QByteArray &array, Registe &registe) {
     QJsonDocument doc = QJsonDocument::fromJson(array);
     if (!doc.isObject()) {
         qWarning() << "fromJson registe failed";
-        return;
+        return false;
     }
 
     QJsonObject obj = doc.object();
     if (!obj.contains("id") || !obj.contains("date") || !obj.contains("hash")\
         || !obj.contains("state")) {
         qWarning() << "id date code state not exist in registe array";
-        return;
+        return false;
     }
     
     registe.id = obj.value("id").toString();
     registe.date = obj.value("date").toString();
     registe.hash = obj.value("hash").toString();
     registe.state = obj.value("state").toBool();
+
+    return true;
+}
+
+inline void toWire(Wire::Writer &writer, const Registe &registe) {
+    writer.add(Wire::TagType, registe.type);
+    writer.add(Wire::TagId, registe.id);
+    writer.add(Wire::TagHash, registe.hash);
+    writer.add(Wire::TagState, int64_t(registe.state));
+    writer.add(Wire::TagDate, registe.date);
+}
+
+inline bool fromWire(Wire::Reader &reader, Registe &registe) {
+    registe.state = false;
+    while (reader.next()) {
+        switch (reader.tag()) {
+        case Wire::TagId: registe.id = reader.string(); break;
+        case Wire::TagHash: registe.hash = reader.string(); break;
+        case Wire::TagState: registe.state = reader.integer(); break;
+        case Wire::TagDate: registe.date = reader.string(); break;
+        default: break;
+        }
+    }
+
+    return reader.atEnd();
 }
 
 }  // namespace Methods
@@ -6,6 +6,8 @@
 #define B0B88BD6_CF1E_4E87_926A_E6DBE6B9B19C
 
 
+#include "wire.h"
+
 #include <utility>
 #include <QList>
 #include <QMap>
@@ -48,14 +50,14 @@ namespace Methods
             {"environments", QJsonObject::fromVariantMap(envsMap)}
         };
 
-        array = QJsonDocument(obj).toJson();
+        array = QJsonDocument(obj).toJson(QJsonDocument::Compact);
     }
 
-    inline void fromJson(const QByteArray &array, Task &task) {
+    inline bool fromJson(const QByteArray &array, Task &task) {
         QJsonDocument doc = QJsonDocument::fromJson(array);
 		if (!doc.isObject()) {
 			qWarning() << "fromJson task failed";
-			return;
+			return false;
 		}
         QJsonObject obj = doc.object();
         if (obj.contains("id")) {
@@ -82,6 +84,41 @@ namespace Methods
                 task.environments.insert(it.key(), it.value().toString());
             }
         }
+
+        return true;
+    }
+
+    inline void toWire(Wire::Writer &writer, const Task &task) {
+        writer.add(Wire::TagType, task.type);
+        writer.add(Wire::TagId, task.id);
+        writer.add(Wire::TagRunId, task.runId);
+        writer.add(Wire::TagFilePath, task.filePath);
+        writer.add(Wire::TagDate, task.date);
+        for (const QString &arg : task.arguments)
+            writer.add(Wire::TagArgument, arg);
+
+        for (auto it = task.environments.constBegin(); it != task.environments.constEnd(); ++it)
+            writer.add(Wire::TagEnvironment, it.key(), it.value());
+    }
+
+    inline bool fromWire(Wire::Reader &reader, Task &task) {
+        QString key, value;
+        while (reader.next()) {
+            switch (reader.tag()) {
+            case Wire::TagId: task.id = reader.string(); break;
+            case Wire::TagRunId: task.runId = reader.string(); break;
+            case Wire::TagFilePath: task.filePath = reader.string(); break;
+            case Wire::TagDate: task.date = reader.string(); break;
+            case Wire::TagArgument: task.arguments.append(reader.string()); break;
+            case Wire::TagEnvironment:
+                if (reader.pair(key, value))
+                    task.environments.insert(key, value);
+                break;
+            default: break;
+            }
+        }
+
+        return reader.atEnd();
     }
 } // namespace Methods
 
@@ -0,0 +1,433 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef WIRE_H_
+#define WIRE_H_
+
+#include "basic.h"
+
+#include <QByteArray>
+#include <QString>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace Methods {
+/**
+ * loader与AM之间的消息帧
+ * 帧头8字节: 'D' 'A' 版本 标志 负载长度(uint32，小端)
+ * 负载为若干TLV: tag(uint16，小端) 长度(uint32，小端) 值，字符串为UTF-8，整数为int64小端，
+ * 列表重复同一个tag，不认识的tag跳过。
+ * 标志中FlagJson置位时负载为紧凑JSON，设置环境变量DAM_WIRE_JSON=1时loader使用这种格式，便于调试，
+ * AM按请求的格式回复。
+ * 通过loader启动时，AM把Task帧写入密封的memfd，fd号通过环境变量DAM_TASK_FD交给loader，
+ * loader直接读取，不再需要registe、instance两次请求。
+ * zygote模式下，AM通过DAM_ZYGOTE_FD指定的SOCK_SEQPACKET控制套接字用SCM_RIGHTS传递同样的fd，
+ * 每条消息的内容为实例hash。
+ */
+namespace Wire {
+
+const char Magic[2] = {'D', 'A'};
+const uint8_t Version = 1;
+const uint8_t FlagJson = 0x01;
+const size_t HeaderSize = 8;
+const size_t FieldHeaderSize = 6;
+const uint32_t MaxPayloadSize = 16 * 1024 * 1024;
+// AM启动的loader从该环境变量取得密封的任务fd，zygote的worker通过控制套接字收到fd
+const char TaskFdEnv[] = "DAM_TASK_FD";
+// 交付后内容和大小都不能再改变
+const int TaskFdSeals = F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL;
+const char ZygoteFdEnv[] = "DAM_ZYGOTE_FD";
+const char ZygotePoolEnv[] = "DAM_ZYGOTE_POOL";
+const size_t MaxHashSize = 128;
+
+enum Tag : uint16_t {
+    TagType = 1,
+    TagId,
+    TagHash,
+    TagDate,
+    TagState,
+    TagRunId,
+    TagFilePath,
+    TagArgument,    // 可重复
+    TagEnvironment, // 可重复，KEY=VALUE
+    TagData,
+    TagCode,
+};
+
+inline uint32_t readU32(const char *p)
+{
+    const unsigned char *u = reinterpret_cast<const unsigned char *>(p);
+    return uint32_t(u[0]) | uint32_t(u[1]) << 8 | uint32_t(u[2]) << 16 | uint32_t(u[3]) << 24;
+}
+
+inline void writeU32(char *p, uint32_t value)
+{
+    for (int i = 0; i < 4; ++i)
+        p[i] = char(value >> (8 * i));
+}
+
+// 完整帧的长度，数据不足时返回0，不是合法的帧时返回-1
+inline long frameSize(const char *data, size_t size)
+{
+    if ((size > 0 && data[0] != Magic[0]) || (size > 1 && data[1] != Magic[1])
+            || (size > 2 && uint8_t(data[2]) != Version))
+        return -1;
+
+    if (size < HeaderSize)
+        return 0;
+
+    const uint32_t payloadSize = readU32(data + 4);
+    if (payloadSize > MaxPayloadSize)
+        return -1;
+
+    return size >= HeaderSize + payloadSize ? long(HeaderSize + payloadSize) : 0;
+}
+
+inline bool isJson(const std::vector<char> &frame)
+{
+    return frame.size() >= HeaderSize && (uint8_t(frame[3]) & FlagJson);
+}
+
+// 调试时通过DAM_WIRE_JSON=1使用JSON负载
+inline bool jsonMode()
+{
+    static const bool json = [] {
+        const char *env = getenv("DAM_WIRE_JSON");
+        return env && !strcmp(env, "1");
+    }();
+    return json;
+}
+
+class Writer
+{
+public:
+    explicit Writer(uint8_t flags = 0)
+    {
+        m_frame.reserve(512);
+        m_frame.assign({Magic[0], Magic[1], char(Version), char(flags), 0, 0, 0, 0});
+    }
+
+    void add(Tag tag, const char *value, size_t size)
+    {
+        const size_t pos = m_frame.size();
+        m_frame.resize(pos + FieldHeaderSize + size);
+        m_frame[pos] = char(tag);
+        m_frame[pos + 1] = char(tag >> 8);
+        writeU32(&m_frame[pos + 2], uint32_t(size));
+        if (size)
+            memcpy(&m_frame[pos + FieldHeaderSize], value, size);
+    }
+
+    void add(Tag tag, const QString &value)
+    {
+        const QByteArray utf8 = value.toUtf8();
+        add(tag, utf8.constData(), size_t(utf8.size()));
+    }
+
+    // KEY=VALUE
+    void add(Tag tag, const QString &key, const QString &value)
+    {
+        QByteArray pair = key.toUtf8();
+        pair += '=';
+        pair += value.toUtf8();
+        add(tag, pair);
+    }
+
+    void add(Tag tag, const QByteArray &value)
+    {
+        add(tag, value.constData(), size_t(value.size()));
+    }
+
+    void add(Tag tag, int64_t value)
+    {
+        char buf[8];
+        for (int i = 0; i < 8; ++i)
+            buf[i] = char(uint64_t(value) >> (8 * i));
+
+        add(tag, buf, sizeof(buf));
+    }
+
+    void setPayload(const QByteArray &payload)
+    {
+        m_frame.resize(HeaderSize);
+        m_frame.insert(m_frame.end(), payload.constBegin(), payload.constEnd());
+    }
+
+    std::vector<char> finish()
+    {
+        writeU32(&m_frame[4], uint32_t(m_frame.size() - HeaderSize));
+        return std::move(m_frame);
+    }
+
+private:
+    std::vector<char> m_frame;
+};
+
+// 依次读取帧中的字段，值直接引用帧的数据
+class Reader
+{
+public:
+    explicit Reader(const std::vector<char> &frame)
+        : m_pos(frame.size() >= HeaderSize ? frame.data() + HeaderSize : nullptr)
+        , m_end(frame.size() >= HeaderSize ? frame.data() + frame.size() : nullptr)
+        , m_value(nullptr)
+        , m_size(0)
+        , m_tag(0)
+    {
+    }
+
+    bool next()
+    {
+        if (size_t(m_end - m_pos) < FieldHeaderSize)
+            return false;
+
+        const uint32_t size = readU32(m_pos + 2);
+        if (size > size_t(m_end - m_pos) - FieldHeaderSize)
+            return false;
+
+        m_tag = uint16_t(uint8_t(m_pos[0]) | uint8_t(m_pos[1]) << 8);
+        m_value = m_pos + FieldHeaderSize;
+        m_size = size;
+        m_pos = m_value + size;
+        return true;
+    }
+
+    uint16_t tag() const
+    {
+        return m_tag;
+    }
+
+    // 所有字段都已读完，最后一个字段被截断时为false
+    bool atEnd() const
+    {
+        return m_pos == m_end;
+    }
+
+    QString string() const
+    {
+        return QString::fromUtf8(m_value, int(m_size));
+    }
+
+    int64_t integer() const
+    {
+        uint64_t value = 0;
+        for (uint32_t i = 0; i < m_size && i < 8; ++i)
+            value |= uint64_t(uint8_t(m_value[i])) << (8 * i);
+
+        return int64_t(value);
+    }
+
+    // KEY=VALUE，没有'='时返回false
+    bool pair(QString &key, QString &value) const
+    {
+        const char *sep = static_cast<const char *>(memchr(m_value, '=', m_size));
+        if (!sep)
+            return false;
+
+        key = QString::fromUtf8(m_value, int(sep - m_value));
+        value = QString::fromUtf8(sep + 1, int(m_value + m_size - sep - 1));
+        return true;
+    }
+
+private:
+    const char *m_pos;
+    const char *m_end;
+    const char *m_value;
+    uint32_t m_size;
+    uint16_t m_tag;
+};
+
+template<typename T>
+std::vector<char> encode(const T &message, bool json = jsonMode())
+{
+    if (json) {
+        QByteArray array;
+        toJson(array, message);
+        Writer writer(FlagJson);
+        writer.setPayload(array);
+        return writer.finish();
+    }
+
+    Writer writer;
+    toWire(writer, message);
+    return writer.finish();
+}
+
+// 帧不完整、JSON无效或字段被截断时返回false，此时message可能只填充了一部分
+template<typename T>
+bool decode(const std::vector<char> &frame, T &message)
+{
+    if (frame.size() < HeaderSize || frameSize(frame.data(), frame.size()) != long(frame.size()))
+        return false;
+
+    if (isJson(frame))
+        return fromJson(QByteArray::fromRawData(frame.data() + HeaderSize, int(frame.size() - HeaderSize)), message);
+
+    Reader reader(frame);
+    return fromWire(reader, message);
+}
+
+// 消息类型，用于分发
+inline QString messageType(const std::vector<char> &frame)
+{
+    if (isJson(frame)) {
+        Basic basic;
+        fromJson(QByteArray::fromRawData(frame.data() + HeaderSize, int(frame.size() - HeaderSize)), basic);
+        return basic.type;
+    }
+
+    Reader reader(frame);
+    while (reader.next()) {
+        if (reader.tag() == TagType)
+            return reader.string();
+    }
+
+    return QString();
+}
+
+// 把帧写入密封的memfd，fd不带CLOEXEC以便子进程继承，失败返回-1
+inline int createSealedFd(const std::vector<char> &frame)
+{
+    int fd = memfd_create("dam-task", MFD_ALLOW_SEALING);
+    if (fd < 0)
+        return -1;
+
+    size_t written = 0;
+    while (written < frame.size()) {
+        ssize_t n = write(fd, frame.data() + written, frame.size() - written);
+        if (n < 0 && errno == EINTR)
+            continue;
+
+        if (n <= 0)
+            break;
+
+        written += size_t(n);
+    }
+
+    if (written != frame.size() || fcntl(fd, F_ADD_SEALS, TaskFdSeals) < 0) {
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+// 只接受同一用户创建、已密封的memfd中的完整帧
+inline bool readSealedFd(int fd, std::vector<char> &frame)
+{
+    struct stat st;
+    if (fstat(fd, &st) < 0 || !S_ISREG(st.st_mode) || st.st_uid != getuid())
+        return false;
+
+    const int seals = fcntl(fd, F_GET_SEALS);
+    if (seals < 0 || (seals & TaskFdSeals) != TaskFdSeals)
+        return false;
+
+    if (st.st_size < off_t(HeaderSize) || st.st_size > off_t(HeaderSize + MaxPayloadSize))
+        return false;
+
+    frame.resize(size_t(st.st_size));
+    size_t offset = 0;
+    while (offset < frame.size()) {
+        ssize_t n = pread(fd, frame.data() + offset, frame.size() - offset, off_t(offset));
+        if (n < 0 && errno == EINTR)
+            continue;
+
+        if (n <= 0)
+            return false;
+
+        offset += size_t(n);
+    }
+
+    return frameSize(frame.data(), frame.size()) == long(frame.size());
+}
+
+// 通过控制套接字交付任务fd，不阻塞
+inline bool sendTaskFd(int socket, const std::string &hash, int fd)
+{
+    if (hash.empty() || hash.size() > MaxHashSize)
+        return false;
+
+    struct iovec iov;
+    iov.iov_base = const_cast<char *>(hash.data());
+    iov.iov_len = hash.size();
+
+    union {
+        char buf[CMSG_SPACE(sizeof(int))];
+        struct cmsghdr align;
+    } control;
+    memset(&control, 0, sizeof(control));
+
+    struct msghdr msg = {};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.buf;
+    msg.msg_controllen = sizeof(control.buf);
+
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+    memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+
+    ssize_t n;
+    do {
+        n = sendmsg(socket, &msg, MSG_DONTWAIT | MSG_NOSIGNAL);
+    } while (n < 0 && errno == EINTR);
+
+    return n == ssize_t(hash.size());
+}
+
+// 阻塞等待一个任务fd，控制套接字关闭或出错时返回-1
+inline int recvTaskFd(int socket, std::string &hash)
+{
+    char buf[MaxHashSize];
+    struct iovec iov;
+    iov.iov_base = buf;
+    iov.iov_len = sizeof(buf);
+
+    union {
+        char buf[CMSG_SPACE(sizeof(int))];
+        struct cmsghdr align;
+    } control;
+
+    struct msghdr msg = {};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.buf;
+    msg.msg_controllen = sizeof(control.buf);
+
+    ssize_t n;
+    do {
+        n = recvmsg(socket, &msg, MSG_CMSG_CLOEXEC);
+    } while (n < 0 && errno == EINTR);
+
+    if (n <= 0)
+        return -1;
+
+    int fd = -1;
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    if (cmsg && cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS
+            && cmsg->cmsg_len == CMSG_LEN(sizeof(int)))
+        memcpy(&fd, CMSG_DATA(cmsg), sizeof(int));
+
+    hash.assign(buf, size_t(n));
+    return fd;
+}
+
+} // namespace Wire
+} // namespace Methods
+
+#endif // WIRE_H_
@@ -3,11 +3,14 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 
 #include "client.h"
+#include "../methods/wire.h"
 
 #include <sys/socket.h>
 #include <sys/un.h>
 #include <unistd.h>
 
+#include <cerrno>
+#include <cstring>
 #include <thread>
 
 namespace Socket {
@@ -51,21 +54,10 @@ struct ClientPrivate {
         // TODO readFunc function?
         if (readFunc) {
             readThread = new std::thread([=] {
-                char              buf[512];
-                std::vector<char> result;
-                int               bytesRead;
-                while ((bytesRead = recv(socket_fd, buf, 512, 0)) > 0) {
-                    if (bytesRead == -1) {
-                        return;
-                    }
-                    for (int i = 0; i < bytesRead; i++) {
-                        result.push_back(buf[i]);
-                    }
-                    if (buf[bytesRead - 1] == '\0') {
-                        readFunc(result);
-                        result.clear();
-                    }
-                };
+                std::vector<char> frame;
+                while (readFrame(frame)) {
+                    readFunc(frame);
+                }
             });
             readThread->detach();
         }
@@ -73,30 +65,61 @@ struct ClientPrivate {
         return true;
     }
 
-    QByteArray get(const QByteArray &call) {
-        send(call);
+    std::vector<char> get(const std::vector<char> &call) {
+        std::vector<char> frame;
+        if (send(call) != call.size() || !readFrame(frame)) {
+            frame.clear();
+        }
 
-        char buf[512];
-        std::vector<char> data;
-        int bytesRead;
-        while ((bytesRead = recv(socket_fd, buf, 512, 0)) > 0) {
-            for (int i = 0; i < bytesRead; ++i) {
-                data.push_back(buf[i]);
-            }
+        return frame;
+    }
 
-            if (buf[bytesRead - 1] == '\0') {
+    size_t send(const std::vector<char> &call) {
+        size_t written = 0;
+        while (written < call.size()) {
+            ssize_t n = write(socket_fd, call.data() + written, call.size() - written);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
                 break;
             }
+            written += size_t(n);
         }
 
-        return data.data();
+        return written;
     }
 
-    size_t send(const QByteArray &call) {
-        std::string data = call.data();
-        // \0 作为结尾标记
-        data += '\0';
-        return write(socket_fd, data.c_str(), data.length());
+    // 先读帧头得到长度，再读负载
+    bool readFrame(std::vector<char> &frame) {
+        frame.resize(Methods::Wire::HeaderSize);
+        if (!readAll(frame.data(), frame.size())) {
+            return false;
+        }
+
+        if (Methods::Wire::frameSize(frame.data(), frame.size()) < 0) {
+            printf("invalid frame\n");
+            return false;
+        }
+
+        frame.resize(Methods::Wire::HeaderSize + Methods::Wire::readU32(frame.data() + 4));
+        return readAll(frame.data() + Methods::Wire::HeaderSize, frame.size() - Methods::Wire::HeaderSize);
+    }
+
+    bool readAll(char *data, size_t size) {
+        while (size > 0) {
+            ssize_t n = recv(socket_fd, data, size, 0);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                return false;
+            }
+            data += n;
+            size -= size_t(n);
+        }
+
+        return true;
     }
 };
 
@@ -109,12 +132,12 @@ bool Client::connect(const std::string& host)
     return d_ptr->connect(host);
 }
 
-QByteArray Client::get(const QByteArray &call)
+std::vector<char> Client::get(const std::vector<char> &call)
 {
     return d_ptr->get(call);
 }
 
-size_t Client::send(const QByteArray &call)
+size_t Client::send(const std::vector<char> &call)
 {
     return d_ptr->send(call);
 }
@@ -8,8 +8,7 @@
 #include <functional>
 #include <memory>
 #include <string>
-
-#include <QJsonDocument>
+#include <vector>
 
 namespace Socket
 {
@@ -22,8 +21,9 @@ namespace Socket
         Client();
         ~Client();
         bool connect(const std::string &host);
-        QByteArray get(const QByteArray &call);
-        size_t send(const QByteArray &call);
+        // 收发Methods::Wire帧，get失败时返回空
+        std::vector<char> get(const std::vector<char> &call);
+        size_t send(const std::vector<char> &call);
         void onReadyRead(std::function<void(const std::vector<char> &)> func);
         void waitForFinished();
     };
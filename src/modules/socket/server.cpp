@@ -3,87 +3,124 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 
 #include "server.h"
+#include "../methods/wire.h"
 
 #include <qnamespace.h>
 #include <qobject.h>
 #include <qobjectdefs.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include <sys/socket.h>
 #include <sys/un.h>
 #include <unistd.h>
 
 #include <QThread>
-#include <QtConcurrent/QtConcurrent>
+#include <cerrno>
+#include <cstring>
 #include <iostream>
 
 namespace Socket {
 
+namespace {
+
+const int MaxEvents = 64;
+const size_t ReadBufferSize = 16 * 1024;
+
+} // namespace
+
 ServerPrivate::ServerPrivate(Server *server)
  : QObject()
  , q_ptr(server)
  , socket_fd(-1)
+ , epoll_fd(-1)
+ , event_fd(-1)
  , workThread(nullptr)
+ , nextId(0)
+ , stopped(false)
 {
-    if ((socket_fd = socket(AF_UNIX, SOCK_STREAM, 0)) < 0) {
+    if ((socket_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0)) < 0) {
         std::cout << "socket() failed" << std::endl;
         return;
     }
 
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    event_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (epoll_fd < 0 || event_fd < 0) {
+        std::cout << "epoll_create1() or eventfd() failed" << std::endl;
+        return;
+    }
+
+    struct epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.fd = event_fd;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, event_fd, &event);
+
     connect(this, &ServerPrivate::requestStart, this, &ServerPrivate::work, Qt::QueuedConnection);
 }
 
 ServerPrivate::~ServerPrivate()
 {
+    for (const auto &connection : connections)
+        ::close(connection.first);
 
+    for (int fd : {socket_fd, epoll_fd, event_fd}) {
+        if (fd >= 0)
+            ::close(fd);
+    }
 }
 
 void ServerPrivate::work()
 {
-    // 处理客户端数据
-    while (true) {
-        // 阻塞等待客户端连接
-        int socket = accept(socket_fd, nullptr, nullptr);
-        if (socket == -1) {
-            std::cout << "accept() failed" << std::endl;
+    struct epoll_event events[MaxEvents];
+    while (!stopped) {
+        int count = epoll_wait(epoll_fd, events, MaxEvents, -1);
+        if (count < 0) {
+            if (errno == EINTR)
+                continue;
+
+            std::cout << "epoll_wait() failed" << std::endl;
             return;
         }
-        QtConcurrent::run([=] {
-            int               readBytes = 0;
-            char              buffer[1024];
-            std::vector<char> data;
-            while (true) {
-                readBytes = recv(socket, buffer, 1024, 0);
-                if (readBytes == -1) {
-                    std::cout << "client connect closed" << std::endl;
-                    break;
-                }
-
-                if (readBytes == 0) {
-                    break;
-                }
-
-                for (int i = 0; i != readBytes; i++) {
-                    data.push_back(buffer[i]);
-                }
-
-                if (buffer[readBytes - 1] == '\0') {
-                    Q_EMIT q_ptr->onReadyRead(socket, data);
-                    data.clear();
-                }
+
+        for (int i = 0; i < count; ++i) {
+            const int fd = events[i].data.fd;
+            if (fd == event_fd) {
+                eventfd_t value;
+                eventfd_read(event_fd, &value);
+                handleRequests();
+                continue;
             }
-        });
+
+            if (fd == socket_fd) {
+                acceptClients();
+                continue;
+            }
+
+            auto iter = connections.find(fd);
+            if (iter == connections.end())
+                continue;
+
+            if (events[i].events & EPOLLOUT) {
+                if (!flushClient(fd, iter->second))
+                    continue;
+            }
+
+            if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR | EPOLLRDHUP))
+                readClient(fd, iter->second);
+        }
     }
 }
 
 bool ServerPrivate::listen(const std::string &host)
 {
-    if (socket_fd < 0) {
+    if (socket_fd < 0 || epoll_fd < 0 || event_fd < 0) {
         return false;
     }
 
     struct sockaddr_un addr;
     memset(&addr, 0, sizeof(struct sockaddr_un));
     addr.sun_family = AF_UNIX;
-    snprintf(addr.sun_path, host.size() + 1, "%s", host.c_str());
+    snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", host.c_str());
 
     // 移除原有套接字文件
     if (remove(host.c_str()) == -1 && errno != ENOENT) {
@@ -97,23 +134,202 @@ bool ServerPrivate::listen(const std::string &host)
         return false;
     }
 
-    // 监听客户端连接
-    if (::listen(socket_fd, 20) < 0) {
+    // 监听客户端连接，自启动时会有大量loader同时连接
+    if (::listen(socket_fd, SOMAXCONN) < 0) {
         std::cout << "listen() failed" << std::endl;
         return false;
     }
 
+    struct epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.fd = socket_fd;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, socket_fd, &event) < 0) {
+        std::cout << "epoll_ctl() failed" << std::endl;
+        return false;
+    }
+
     return true;
 }
 
-void ServerPrivate::write(int socket, const std::vector<char> &data)
+// 可在任意线程调用，由事件循环线程写入
+void ServerPrivate::write(int socket, quint64 id, const std::vector<char> &data)
+{
+    {
+        std::lock_guard<std::mutex> lock(requestMutex);
+        requests.push_back({socket, id, data, false});
+    }
+    wakeup();
+}
+
+void ServerPrivate::closeClient(int socket, quint64 id)
+{
+    {
+        std::lock_guard<std::mutex> lock(requestMutex);
+        requests.push_back({socket, id, {}, true});
+    }
+    wakeup();
+}
+
+void ServerPrivate::stop()
+{
+    stopped = true;
+    wakeup();
+}
+
+void ServerPrivate::wakeup()
+{
+    eventfd_write(event_fd, 1);
+}
+
+void ServerPrivate::acceptClients()
+{
+    while (true) {
+        int socket = accept4(socket_fd, nullptr, nullptr, SOCK_CLOEXEC | SOCK_NONBLOCK);
+        if (socket < 0) {
+            if (errno == EINTR || errno == ECONNABORTED)
+                continue;
+
+            // EMFILE等错误时连接留在队列中，下次可读时再接受
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+                std::cout << "accept4() failed: " << strerror(errno) << std::endl;
+
+            return;
+        }
+
+        struct ucred cred;
+        socklen_t credLen = sizeof(cred);
+        if (getsockopt(socket, SOL_SOCKET, SO_PEERCRED, &cred, &credLen) < 0 || cred.uid != getuid()) {
+            std::cout << "reject client of other user" << std::endl;
+            ::close(socket);
+            continue;
+        }
+
+        struct epoll_event event = {};
+        event.events = EPOLLIN | EPOLLRDHUP;
+        event.data.fd = socket;
+        if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, socket, &event) < 0) {
+            std::cout << "epoll_ctl() failed" << std::endl;
+            ::close(socket);
+            continue;
+        }
+
+        Connection &connection = connections[socket];
+        connection = Connection();
+        connection.pid = cred.pid;
+        connection.id = ++nextId;
+    }
+}
+
+void ServerPrivate::readClient(int socket, Connection &connection)
+{
+    char buffer[ReadBufferSize];
+    while (true) {
+        ssize_t readBytes = recv(socket, buffer, sizeof(buffer), 0);
+        if (readBytes < 0) {
+            if (errno == EINTR)
+                continue;
+
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                return;
+
+            std::cout << "client connect closed" << std::endl;
+            removeClient(socket);
+            return;
+        }
+
+        if (readBytes == 0) {
+            removeClient(socket);
+            return;
+        }
+
+        // 一次读取可能包含多个或半个帧
+        connection.in.insert(connection.in.end(), buffer, buffer + readBytes);
+        size_t offset = 0;
+        long size;
+        while ((size = Methods::Wire::frameSize(connection.in.data() + offset, connection.in.size() - offset)) > 0) {
+            Q_EMIT q_ptr->onReadyRead(socket, connection.id, std::vector<char>(connection.in.begin() + offset,
+                                                                connection.in.begin() + offset + size),
+                                      connection.pid);
+            offset += size_t(size);
+        }
+
+        if (size < 0) {
+            std::cout << "invalid frame, close client" << std::endl;
+            removeClient(socket);
+            return;
+        }
+
+        connection.in.erase(connection.in.begin(), connection.in.begin() + offset);
+    }
+}
+
+// 返回false表示连接已关闭
+bool ServerPrivate::flushClient(int socket, Connection &connection)
 {
-    ::write(socket, data.data(), data.size());
+    while (connection.outOffset < connection.out.size()) {
+        ssize_t written = send(socket, connection.out.data() + connection.outOffset,
+                               connection.out.size() - connection.outOffset, MSG_NOSIGNAL);
+        if (written < 0) {
+            if (errno == EINTR)
+                continue;
+
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                break;
+
+            removeClient(socket);
+            return false;
+        }
+
+        connection.outOffset += size_t(written);
+    }
+
+    const bool pending = connection.outOffset < connection.out.size();
+    if (!pending) {
+        connection.out.clear();
+        connection.outOffset = 0;
+        if (connection.closing) {
+            removeClient(socket);
+            return false;
+        }
+    }
+
+    // 只在有未写完的数据时关注可写事件
+    struct epoll_event event = {};
+    event.events = EPOLLIN | EPOLLRDHUP | (pending ? EPOLLOUT : 0);
+    event.data.fd = socket;
+    epoll_ctl(epoll_fd, EPOLL_CTL_MOD, socket, &event);
+    return true;
 }
 
-void ServerPrivate::closeClient(int socket)
+void ServerPrivate::removeClient(int socket)
 {
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, socket, nullptr);
     ::close(socket);
+    connections.erase(socket);
+}
+
+void ServerPrivate::handleRequests()
+{
+    std::vector<Request> pending;
+    {
+        std::lock_guard<std::mutex> lock(requestMutex);
+        pending.swap(requests);
+    }
+
+    for (Request &request : pending) {
+        // 客户端可能已经断开，fd也可能已被新的连接复用
+        auto iter = connections.find(request.socket);
+        if (iter == connections.end() || iter->second.id != request.id)
+            continue;
+
+        Connection &connection = iter->second;
+        if (request.close)
+            connection.closing = true;
+        else
+            connection.out.insert(connection.out.end(), request.data.begin(), request.data.end());
+
+        flushClient(request.socket, connection);
+    }
 }
 
 
@@ -126,7 +342,12 @@ Server::Server()
 
 Server::~Server()
 {
-
+    if (d_ptr->workThread) {
+        d_ptr->stop();
+        d_ptr->workThread->quit();
+        d_ptr->workThread->wait();
+        delete d_ptr->workThread;
+    }
 }
 
 bool Server::listen(const std::string &host)
@@ -147,14 +368,14 @@ bool Server::listen(const std::string &host)
     return result;
 }
 
-void Server::write(int socket, const std::vector<char> &data)
+void Server::write(int socket, quint64 id, const std::vector<char> &data)
 {
-    d_ptr->write(socket, data);
+    d_ptr->write(socket, id, data);
 }
 
-void Server::close(int socket)
+void Server::close(int socket, quint64 id)
 {
-    d_ptr->closeClient(socket);
+    d_ptr->closeClient(socket, id);
 }
 
 }  // namespace Socket
@@ -5,20 +5,33 @@
 #ifndef F358257E_94E5_4A6C_91A8_4B6E57999E7B
 #define F358257E_94E5_4A6C_91A8_4B6E57999E7B
 
+#include <atomic>
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include <QObject>
 
 namespace Socket {
 
 class Server;
+/**
+ * @brief The ServerPrivate class 单线程epoll事件循环
+ * 监听套接字和客户端套接字均为非阻塞，每个连接有独立的读写缓冲区，
+ * 消息使用Methods::Wire的长度前缀帧，不是合法帧的连接直接断开。
+ * 接受连接时通过SO_PEERCRED校验对端，只接受同一用户的进程，对端pid随消息一起发出。其它线程的写入和关闭请求放入队列，通过eventfd唤醒事件循环处理，
+ * 不占用全局线程池。
+ * fd关闭后可能被新连接复用，每个连接另有一个不重复的id，随消息发出，请求中的id与当前连接不一致时丢弃。
+ */
 class ServerPrivate : public QObject {
     Q_OBJECT
 public:
     Server  *q_ptr;
     int      socket_fd;
+    int      epoll_fd;
+    int      event_fd;
     QThread *workThread;
 
 Q_SIGNALS:
@@ -30,8 +43,39 @@ public:
 
     void work();
     bool listen(const std::string &host);
-    void write(int socket, const std::vector<char> &data);
-    void closeClient(int socket);
+    void write(int socket, quint64 id, const std::vector<char> &data);
+    void closeClient(int socket, quint64 id);
+    void stop();
+
+private:
+    struct Connection {
+        std::vector<char> in;   // 未收完整的帧
+        std::vector<char> out;  // 未写完的数据
+        size_t outOffset = 0;
+        bool closing = false;   // 写完后关闭
+        int pid = 0;            // 对端进程
+        quint64 id = 0;
+    };
+
+    struct Request {
+        int socket;
+        quint64 id;
+        std::vector<char> data;
+        bool close;
+    };
+
+    void wakeup();
+    void acceptClients();
+    void readClient(int socket, Connection &connection);
+    bool flushClient(int socket, Connection &connection);
+    void removeClient(int socket);
+    void handleRequests();
+
+    std::unordered_map<int, Connection> connections; // 只在事件循环线程中访问
+    quint64 nextId;
+    std::mutex requestMutex;
+    std::vector<Request> requests;
+    std::atomic<bool> stopped;
 };
 
 
@@ -43,10 +87,11 @@ public:
     Server();
     ~Server();
     bool listen(const std::string& host);
-    void write(int socket, const std::vector<char>& data);
-    void close(int socket);
+    // id为onReadyRead中收到的连接id，连接已关闭时请求被丢弃
+    void write(int socket, quint64 id, const std::vector<char>& data);
+    void close(int socket, quint64 id);
 Q_SIGNALS:
-    void onReadyRead(int socket, const std::vector<char>& data) const;
+    void onReadyRead(int socket, quint64 id, const std::vector<char>& data, int pid) const;
 };
 }  // namespace Socket
 
@@ -0,0 +1,156 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "autostartscheduler.h"
+#include "common.h"
+#include "desktopinfo.h"
+#include "startmanager.h"
+
+#include <QDebug>
+#include <QTimer>
+
+#include <algorithm>
+#include <memory>
+
+namespace {
+
+// gnome-session定义的启动阶段，未设置或无法识别时为Applications
+const char *const Phases[] = {
+    "EarlyInitialization",
+    "PreDisplayServer",
+    "DisplayServer",
+    "Initialization",
+    "WindowManager",
+    "Panel",
+    "Desktop",
+    "Applications",
+};
+const int PhaseCount = int(sizeof(Phases) / sizeof(Phases[0]));
+
+int parsePhase(const std::string &phase)
+{
+    for (int i = 0; i < PhaseCount; ++i) {
+        if (phase == Phases[i])
+            return i;
+    }
+
+    return PhaseCount - 1;
+}
+
+} // namespace
+
+AutostartEntry AutostartEntry::fromDesktop(DesktopInfo &info, const QString &desktopFile)
+{
+    KeyFile *keyFile = info.getDesktopFile();
+
+    AutostartEntry entry;
+    entry.desktopFile = desktopFile;
+    entry.phase = parsePhase(keyFile->getStr(MainSection, KeyXGnomeAutostartPhase.toStdString()));
+    entry.priority = QString::fromStdString(keyFile->getStr(MainSection, KeyXDeepinAutostartPriority.toStdString())).toInt();
+    entry.delay = std::max(0, QString::fromStdString(keyFile->getStr(MainSection, KeyXGnomeAutostartDelay.toStdString())).toInt());
+    return entry;
+}
+
+AutostartScheduler::AutostartScheduler(StartManager *manager)
+ : QObject(manager)
+ , m_manager(manager)
+ , m_waiting(0)
+ , m_running(0)
+ , m_parallel(1)
+ , m_phase(0)
+ , m_launched(0)
+ , m_failed(0)
+ , m_slowestMs(0)
+{
+}
+
+void AutostartScheduler::start(QList<AutostartEntry> entries, int delay, int parallel)
+{
+    m_parallel = std::max(1, parallel);
+    m_elapsed.start();
+
+    std::stable_sort(entries.begin(), entries.end(), [](const AutostartEntry &a, const AutostartEntry &b) {
+        return a.phase != b.phase ? a.phase < b.phase : a.priority > b.priority;
+    });
+
+    for (const AutostartEntry &entry : entries) {
+        if (entry.delay <= 0) {
+            m_pending << entry;
+            continue;
+        }
+
+        ++m_waiting;
+        QTimer::singleShot((delay + entry.delay) * 1000, this, [this, entry] {
+            --m_waiting;
+            m_due << entry;
+            schedule();
+        });
+    }
+
+    if (!m_pending.isEmpty())
+        m_phase = m_pending.first().phase;
+
+    if (delay > 0)
+        QTimer::singleShot(delay * 1000, this, &AutostartScheduler::schedule);
+    else
+        schedule();
+}
+
+void AutostartScheduler::schedule()
+{
+    while (m_running < m_parallel) {
+        // 前一阶段全部启动完成后才进入下一阶段
+        bool fromDue = !m_due.isEmpty();
+        if (!fromDue && (m_pending.isEmpty() || (m_pending.first().phase != m_phase && m_running > 0)))
+            break;
+
+        if (fromDue) {
+            launch(m_due.takeFirst());
+        } else {
+            m_phase = m_pending.first().phase;
+            launch(m_pending.takeFirst());
+        }
+    }
+
+    if (m_pending.isEmpty() && m_due.isEmpty() && !m_waiting && !m_running)
+        report();
+}
+
+void AutostartScheduler::launch(const AutostartEntry &entry)
+{
+    ++m_running;
+
+    std::shared_ptr<QElapsedTimer> timer(new QElapsedTimer);
+    timer->start();
+    const QString desktopFile = entry.desktopFile;
+    m_manager->launchAutostartApp(desktopFile, [this, desktopFile, timer](qint64 pid, int error) {
+        Q_UNUSED(error);
+
+        --m_running;
+        if (pid > 0)
+            ++m_launched;
+        else
+            ++m_failed;
+
+        if (timer->elapsed() > m_slowestMs) {
+            m_slowestMs = timer->elapsed();
+            m_slowest = desktopFile;
+        }
+
+        schedule();
+    });
+}
+
+void AutostartScheduler::report()
+{
+    if (!m_elapsed.isValid())
+        return;
+
+    qInfo() << "autostart finished in" << m_elapsed.elapsed() << "ms, launched:" << m_launched
+            << "failed:" << m_failed << "parallel:" << m_parallel
+            << "slowest:" << m_slowest << m_slowestMs << "ms";
+
+    m_elapsed.invalidate();
+    Q_EMIT finished();
+}
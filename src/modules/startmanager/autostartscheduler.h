@@ -0,0 +1,69 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef AUTOSTARTSCHEDULER_H
+#define AUTOSTARTSCHEDULER_H
+
+#include <QElapsedTimer>
+#include <QList>
+#include <QObject>
+#include <QString>
+
+class DesktopInfo;
+class StartManager;
+
+// 一个自启动项的调度信息，在扫描自启动目录时读取
+struct AutostartEntry {
+    AutostartEntry() : phase(0), priority(0), delay(0) {}
+
+    QString desktopFile;
+    int phase;     // X-GNOME-Autostart-Phase，数值小的先启动
+    int priority;  // X-Deepin-Autostart-Priority，同一阶段中数值大的先启动
+    int delay;     // X-GNOME-Autostart-Delay，秒
+
+    static AutostartEntry fromDesktop(DesktopInfo &info, const QString &desktopFile);
+};
+
+/**
+ * @brief The AutostartScheduler class 会话启动时的自启动调度
+ * 按阶段依次启动，同一阶段内按优先级并行启动，同时进行的启动数不超过上限；
+ * 设置了延迟的项到时后插队启动，不受阶段限制。
+ * 内存压力下的推迟由StartManager启动时的LaunchAdmission处理。
+ * 全部完成后打印本次会话的启动汇总。
+ */
+class AutostartScheduler : public QObject
+{
+    Q_OBJECT
+public:
+    explicit AutostartScheduler(StartManager *manager);
+
+    // delay为全部自启动项的延迟(秒)，parallel为并行启动数上限
+    void start(QList<AutostartEntry> entries, int delay, int parallel);
+
+Q_SIGNALS:
+    // 全部自启动项都已启动(或失败)
+    void finished();
+
+private:
+    void schedule();
+    void launch(const AutostartEntry &entry);
+    void report();
+
+    StartManager *m_manager;
+    QList<AutostartEntry> m_pending; // 按阶段、优先级排序
+    QList<AutostartEntry> m_due;     // 延迟已到，优先启动
+    int m_waiting;                   // 还在等待延迟的项数
+    int m_running;
+    int m_parallel;
+    int m_phase;
+
+    // 汇总信息
+    QElapsedTimer m_elapsed;
+    int m_launched;
+    int m_failed;
+    QString m_slowest;
+    qint64 m_slowestMs;
+};
+
+#endif // AUTOSTARTSCHEDULER_H
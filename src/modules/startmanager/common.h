@@ -14,14 +14,23 @@ const QString proxychainsBinary = "proxychains4";
 const QString configLauncher        = "com.deepin.dde.launcher";
 const QString keyAppsUseProxy       = "Apps_Use_Proxy";
 const QString keyAppsDisableScaling = "Apps_Disable_Scaling";
+const QString keyLaunchCoalesceWindow = "Launch_Coalesce_Window";
 
 const QString KeyXGnomeAutostartDelay = "X-GNOME-Autostart-Delay";
+const QString KeyXGnomeAutostartPhase = "X-GNOME-Autostart-Phase";
 const QString KeyXGnomeAutoRestart    = "X-GNOME-AutoRestart";
 const QString KeyXDeepinCreatedBy     = "X-Deepin-CreatedBy";
 const QString KeyXDeepinAppID         = "X-Deepin-AppID";
+const QString KeyXDeepinAutostartPriority = "X-Deepin-Autostart-Priority";
 
 const QString configStartdde        = "com.deepin.dde.startdde";
 const QString keyAutostartDelay = "Autostart_Delay";
+const QString keyAutostartParallel = "Autostart_Parallel";
+const QString keyPrewarmEnabled = "Prewarm_Enabled";
+const QString keyPrewarmApps = "Prewarm_Apps";
+const QString keyPrewarmBudget = "Prewarm_Budget";
+const QString keyLoaderZygoteEnabled = "Loader_Zygote_Enabled";
+const QString keyLoaderZygotePool = "Loader_Zygote_Pool";
 const QString keyMemCheckerEnabled = "Memchecker_Enabled";
 const QString keySwapSchedEnabled = "swap-sched-enabled";
 
@@ -36,6 +45,13 @@ const QString performanceGovernor = "performance";
 
 const int restartRateLimitSeconds = 60;
 
+const int defaultAutostartParallel = 4;
+const int maxLaunchDeferMs = 3000; // 内存压力下启动最多推迟的时间
+const int defaultLaunchCoalesceWindow = 500; // ms
+const int defaultPrewarmApps = 5;
+const int defaultPrewarmBudget = 128; // MB
+const int defaultLoaderZygotePool = 2;
+
 const QString sysMemLimitConfig = "/usr/share/startdde/memchecker.json";
 
 const int defaultMinMemAvail = 300;  // 300M
@@ -0,0 +1,238 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "desktopexec.h"
+
+#include <QHash>
+#include <QUrl>
+
+#include <algorithm>
+#include <mutex>
+
+namespace {
+
+// 系统中desktop文件通常不超过数百个，超过上限时整体清空重新缓存
+const int MaxCachedExecs = 512;
+
+// %f、%F只接受本地文件，file:// URL转换为路径
+QString localPath(const QString &file)
+{
+    if (file.startsWith(QLatin1String("file:")))
+        return QUrl(file).toLocalFile();
+
+    return file;
+}
+
+bool isSpace(QChar ch)
+{
+    return ch == ' ' || ch == '\t' || ch == '\n';
+}
+
+} // namespace
+
+DesktopExec::DesktopExec(const QString &cmdLine)
+ : m_valid(false)
+{
+    parse(cmdLine);
+}
+
+std::shared_ptr<const DesktopExec> DesktopExec::cached(const QString &cmdLine)
+{
+    static std::mutex mutex;
+    static QHash<QString, std::shared_ptr<const DesktopExec>> cache;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto iter = cache.constFind(cmdLine);
+    if (iter != cache.constEnd())
+        return iter.value();
+
+    if (cache.size() >= MaxCachedExecs)
+        cache.clear();
+
+    auto exec = std::make_shared<const DesktopExec>(cmdLine);
+    cache.insert(cmdLine, exec);
+    return exec;
+}
+
+/**
+ * @brief DesktopExec::parse 分词并识别字段代码
+ * 双引号内只有\"、\`、\$、\\是转义，其余反斜杠保留；
+ * 规范要求保留字符必须加引号，为兼容已有的desktop文件，引号外的反斜杠转义下一个字符，单引号按shell规则处理。
+ * %%展开为%，已废弃的(%d、%D、%n、%N、%v、%m)和未知的字段代码直接删除。
+ */
+void DesktopExec::parse(const QString &cmdLine)
+{
+    const QChar *p = cmdLine.constData();
+    const QChar *end = p + cmdLine.size();
+
+    Arg arg;
+    QString text;
+    bool quoted = false; // ""或''表示空参数，需要保留
+
+    auto flushText = [&] {
+        if (text.isEmpty())
+            return;
+
+        arg.push_back({Text, text});
+        text.clear();
+    };
+
+    auto flushArg = [&] {
+        flushText();
+        if (arg.empty() && quoted)
+            arg.push_back({Text, QString()});
+
+        // 只含被删除的字段代码的参数不保留
+        if (!arg.empty())
+            m_args.push_back(std::move(arg));
+
+        arg.clear();
+        quoted = false;
+    };
+
+    auto fieldCode = [&](QChar code) {
+        Field field;
+        switch (code.unicode()) {
+        case '%': text += '%'; return;
+        case 'f': field = File; break;
+        case 'F': field = Files; break;
+        case 'u': field = Url; break;
+        case 'U': field = Urls; break;
+        case 'i': field = Icon; break;
+        case 'c': field = Name; break;
+        case 'k': field = DesktopFile; break;
+        default: return;
+        }
+
+        flushText();
+        arg.push_back({field, QString()});
+    };
+
+    while (p < end) {
+        const QChar ch = *p++;
+        if (isSpace(ch)) {
+            flushArg();
+            continue;
+        }
+
+        if (ch == '"') {
+            quoted = true;
+            for (;;) {
+                if (p == end)
+                    return;
+
+                const QChar c = *p++;
+                if (c == '"')
+                    break;
+
+                if (c == '\\' && p < end && (*p == '"' || *p == '`' || *p == '$' || *p == '\\')) {
+                    text += *p++;
+                } else if (c == '%' && p < end) {
+                    fieldCode(*p++);
+                } else {
+                    text += c;
+                }
+            }
+        } else if (ch == '\'') {
+            quoted = true;
+            const QChar *close = std::find(p, end, QChar('\''));
+            if (close == end)
+                return;
+
+            text.append(p, int(close - p));
+            p = close + 1;
+        } else if (ch == '\\' && p < end) {
+            text += *p++;
+        } else if (ch == '%' && p < end) {
+            fieldCode(*p++);
+        } else {
+            text += ch;
+        }
+    }
+
+    flushArg();
+    m_valid = !m_args.empty();
+}
+
+/**遵循 freedesktop 规范展开字段代码
+ * @brief DesktopExec::expand
+ * 单独作为参数的%F、%U展开为多个参数，%i展开为"--icon <Icon>"，值为空时删除该参数；
+ * 出现在其他文本中的字段代码按单个值替换。
+ * @param files 启动应用的路径列表
+ * @param entry desktop文件信息
+ * @return 包括可执行程序在内的参数列表
+ */
+QStringList DesktopExec::expand(const QStringList &files, const Entry &entry) const
+{
+    QStringList result;
+    result.reserve(int(m_args.size()) + files.size());
+
+    for (const Arg &arg : m_args) {
+        if (arg.size() == 1 && arg[0].field != Text) {
+            switch (arg[0].field) {
+            case File:
+                if (!files.isEmpty())
+                    result << localPath(files.first());
+                break;
+            case Files:
+                for (const QString &file : files)
+                    result << localPath(file);
+                break;
+            case Url:
+                if (!files.isEmpty())
+                    result << files.first();
+                break;
+            case Urls:
+                result << files;
+                break;
+            case Icon:
+                if (!entry.icon.isEmpty())
+                    result << QStringLiteral("--icon") << entry.icon;
+                break;
+            case Name:
+                if (!entry.name.isEmpty())
+                    result << entry.name;
+                break;
+            case DesktopFile:
+                if (!entry.filePath.isEmpty())
+                    result << entry.filePath;
+                break;
+            case Text:
+                break;
+            }
+            continue;
+        }
+
+        QString value;
+        for (const Segment &segment : arg) {
+            switch (segment.field) {
+            case Text:
+                value += segment.text;
+                break;
+            case File:
+            case Files:
+                if (!files.isEmpty())
+                    value += localPath(files.first());
+                break;
+            case Url:
+            case Urls:
+                if (!files.isEmpty())
+                    value += files.first();
+                break;
+            case Icon:
+                value += entry.icon;
+                break;
+            case Name:
+                value += entry.name;
+                break;
+            case DesktopFile:
+                value += entry.filePath;
+                break;
+            }
+        }
+        result << value;
+    }
+
+    return result;
+}
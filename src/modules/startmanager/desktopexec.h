@@ -0,0 +1,70 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef DESKTOPEXEC_H
+#define DESKTOPEXEC_H
+
+#include <QString>
+#include <QStringList>
+
+#include <memory>
+#include <vector>
+
+/**
+ * @brief The DesktopExec class 按Desktop Entry规范解析的Exec字段
+ * 构造时完成分词(引号、转义)并记录字段代码的位置，启动时只需一次遍历即可展开，
+ * 不再调用wordexp，不会产生shell子进程。
+ * https://specifications.freedesktop.org/desktop-entry-spec/desktop-entry-spec-latest.html#exec-variables
+ */
+class DesktopExec
+{
+public:
+    // 展开%i、%c、%k所需的desktop文件信息
+    struct Entry {
+        QString icon;
+        QString name;     // 已翻译的Name
+        QString filePath;
+    };
+
+    explicit DesktopExec(const QString &cmdLine);
+
+    // 相同Exec的解析结果在进程内共享，缓存数量有上限
+    static std::shared_ptr<const DesktopExec> cached(const QString &cmdLine);
+
+    // 引号不匹配或没有任何参数时无效
+    bool isValid() const
+    {
+        return m_valid;
+    }
+
+    // 展开字段代码，files为启动时传入的文件路径或URL，结果包括可执行程序
+    QStringList expand(const QStringList &files, const Entry &entry) const;
+
+private:
+    enum Field {
+        Text,
+        File,        // %f
+        Files,       // %F
+        Url,         // %u
+        Urls,        // %U
+        Icon,        // %i
+        Name,        // %c
+        DesktopFile, // %k
+    };
+
+    struct Segment {
+        Field field;
+        QString text; // 仅Text使用
+    };
+
+    // 一个参数由若干文本和字段代码组成
+    typedef std::vector<Segment> Arg;
+
+    void parse(const QString &cmdLine);
+
+    std::vector<Arg> m_args;
+    bool m_valid;
+};
+
+#endif // DESKTOPEXEC_H
@@ -0,0 +1,137 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "launchadmission.h"
+#include "meminfo.h"
+
+#include <QDebug>
+#include <QSocketNotifier>
+#include <QTimer>
+
+#include <cerrno>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+namespace {
+
+// 2s内有150ms以上有任务因内存不足而停顿时触发。
+// 非特权进程注册触发器要求窗口为2s的整数倍(Linux 6.4+)
+const char PsiTrigger[] = "some 150000 2000000";
+const qint64 PsiWindowMs = 2000;
+
+// 排队期间检查压力和超时的间隔
+const int CheckIntervalMs = 500;
+
+} // namespace
+
+LaunchAdmission::LaunchAdmission(QObject *parent)
+ : QObject(parent)
+ , m_psiFd(-1)
+ , m_notifier(nullptr)
+ , m_timer(new QTimer(this))
+ , m_lastEvent(0)
+ , m_pressure(false)
+ , m_minMemAvail(0)
+ , m_maxSwapUsed(0)
+{
+    m_clock.start();
+    m_timer->setInterval(CheckIntervalMs);
+    connect(m_timer, &QTimer::timeout, this, &LaunchAdmission::check);
+
+    openPsi();
+}
+
+LaunchAdmission::~LaunchAdmission()
+{
+    if (m_psiFd >= 0)
+        close(m_psiFd);
+}
+
+void LaunchAdmission::setLimits(uint64_t minMemAvail, uint64_t maxSwapUsed)
+{
+    m_minMemAvail = minMemAvail;
+    m_maxSwapUsed = maxSwapUsed;
+}
+
+bool LaunchAdmission::underPressure()
+{
+    if (hasPsi())
+        return m_pressure;
+
+    return !MemInfo::isSufficient(m_minMemAvail, m_maxSwapUsed);
+}
+
+void LaunchAdmission::admit(const std::function<void()> &run, int maxWaitMs)
+{
+    // 已有排队的启动时也要排队，保持顺序
+    if (m_waiting.empty() && !underPressure()) {
+        run();
+        return;
+    }
+
+    qInfo() << "memory pressure, launch deferred for at most" << maxWaitMs << "ms";
+    m_waiting.push_back({run, m_clock.elapsed() + maxWaitMs});
+    if (!m_timer->isActive())
+        m_timer->start();
+}
+
+void LaunchAdmission::openPsi()
+{
+    int fd = open("/proc/pressure/memory", O_RDWR | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) {
+        qInfo() << "PSI not available, checking /proc/meminfo instead:" << strerror(errno);
+        return;
+    }
+
+    // 触发器字符串包括结尾的'\0'
+    if (write(fd, PsiTrigger, sizeof(PsiTrigger)) < 0) {
+        qInfo() << "failed to register PSI trigger, checking /proc/meminfo instead:" << strerror(errno);
+        close(fd);
+        return;
+    }
+
+    m_psiFd = fd;
+    m_notifier = new QSocketNotifier(fd, QSocketNotifier::Exception, this);
+    connect(m_notifier, &QSocketNotifier::activated, this, &LaunchAdmission::onPsiEvent);
+}
+
+void LaunchAdmission::onPsiEvent()
+{
+    m_lastEvent = m_clock.elapsed();
+    setPressure(true);
+    if (!m_timer->isActive())
+        m_timer->start();
+}
+
+void LaunchAdmission::check()
+{
+    // 压力持续时每个窗口期至少触发一次，超过一个窗口期没有触发即认为已解除
+    if (hasPsi() && m_pressure && m_clock.elapsed() - m_lastEvent > PsiWindowMs)
+        setPressure(false);
+
+    const bool pressure = underPressure();
+    const qint64 now = m_clock.elapsed();
+    while (!m_waiting.empty()) {
+        if (pressure && m_waiting.front().deadline > now)
+            break;
+
+        Waiting waiting = m_waiting.front();
+        m_waiting.pop_front();
+        waiting.run();
+    }
+
+    if (m_waiting.empty() && !m_pressure)
+        m_timer->stop();
+}
+
+void LaunchAdmission::setPressure(bool pressure)
+{
+    if (m_pressure == pressure)
+        return;
+
+    m_pressure = pressure;
+    qInfo() << "memory pressure" << (pressure ? "detected" : "relieved");
+    Q_EMIT pressureChanged(pressure);
+}
@@ -0,0 +1,69 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef LAUNCHADMISSION_H
+#define LAUNCHADMISSION_H
+
+#include <QElapsedTimer>
+#include <QObject>
+
+#include <deque>
+#include <functional>
+
+class QSocketNotifier;
+class QTimer;
+
+/**
+ * @brief The LaunchAdmission class 根据内存压力决定启动是否推迟
+ * 内核支持PSI时在/proc/pressure/memory上注册触发器，由事件循环poll，
+ * 触发后进入压力状态，一个窗口期内没有再触发则解除；
+ * 不支持PSI(或无权限注册触发器)时，检查时读取/proc/meminfo与memchecker.json中的阈值比较。
+ * 压力状态下的启动排队，压力解除或等待超时后按顺序执行，不会被拒绝。
+ */
+class LaunchAdmission : public QObject
+{
+    Q_OBJECT
+public:
+    explicit LaunchAdmission(QObject *parent = nullptr);
+    ~LaunchAdmission() override;
+
+    // 没有PSI时使用的阈值(MB)
+    void setLimits(uint64_t minMemAvail, uint64_t maxSwapUsed);
+
+    bool hasPsi() const
+    {
+        return m_psiFd >= 0;
+    }
+
+    bool underPressure();
+
+    // 没有压力时立即执行run，否则排队，最多等待maxWaitMs
+    void admit(const std::function<void()> &run, int maxWaitMs);
+
+Q_SIGNALS:
+    void pressureChanged(bool pressure);
+
+private:
+    void openPsi();
+    void onPsiEvent();
+    void check();
+    void setPressure(bool pressure);
+
+    struct Waiting {
+        std::function<void()> run;
+        qint64 deadline;
+    };
+
+    int m_psiFd;
+    QSocketNotifier *m_notifier;
+    QTimer *m_timer;
+    QElapsedTimer m_clock;
+    qint64 m_lastEvent;
+    bool m_pressure;
+    uint64_t m_minMemAvail;
+    uint64_t m_maxSwapUsed;
+    std::deque<Waiting> m_waiting;
+};
+
+#endif // LAUNCHADMISSION_H
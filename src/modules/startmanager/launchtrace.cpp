@@ -0,0 +1,206 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "launchtrace.h"
+
+#include <QDebug>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMap>
+
+#include <algorithm>
+#include <time.h>
+
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define LAUNCH_TRACE_PROBE(name, ...) DTRACE_PROBE3(dde_application_manager, name, __VA_ARGS__)
+#else
+#define LAUNCH_TRACE_PROBE(name, ...) do {} while (0)
+#endif
+
+namespace {
+
+// 保留最近的启动记录数
+const size_t Capacity = 1024;
+// 总耗时超过该值时打印各阶段耗时
+const qint64 SlowLaunchMs = 1000;
+
+const char *const StageNames[LaunchTrace::StageCount] = {
+    "requested",
+    "admitted",
+    "parsed",
+    "environment_ready",
+    "command_ready",
+    "spawned",
+    "replied",
+    "instance_created",
+    "loader_started",
+    "task_sent",
+    "process_started",
+};
+
+// 首尾时间戳之差，没有记录时返回-1
+qint64 totalNs(const LaunchTrace::Record &record)
+{
+    qint64 first = 0;
+    qint64 last = 0;
+    for (qint64 stamp : record.stamps) {
+        if (!stamp)
+            continue;
+
+        if (!first)
+            first = stamp;
+
+        last = stamp;
+    }
+
+    return first ? last - first : -1;
+}
+
+QJsonObject percentiles(std::vector<qint64> &values)
+{
+    std::sort(values.begin(), values.end());
+    auto at = [&values](size_t percent) {
+        return double(values[(values.size() - 1) * percent / 100]) / 1000;
+    };
+
+    return QJsonObject {
+        {"p50", at(50)},
+        {"p90", at(90)},
+        {"p99", at(99)},
+        {"max", double(values.back()) / 1000},
+    };
+}
+
+} // namespace
+
+LaunchTrace::Record::Record()
+ : stamps{}
+ , error(0)
+{
+
+}
+
+LaunchTrace *LaunchTrace::instance()
+{
+    static LaunchTrace instance;
+    return &instance;
+}
+
+LaunchTrace::LaunchTrace()
+ : m_records(Capacity)
+ , m_next(0)
+ , m_count(0)
+{
+
+}
+
+qint64 LaunchTrace::now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return qint64(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+const char *LaunchTrace::stageName(Stage stage)
+{
+    return stage < StageCount ? StageNames[stage] : "unknown";
+}
+
+void LaunchTrace::mark(Record &record, Stage stage)
+{
+    record.stamps[stage] = now();
+    LAUNCH_TRACE_PROBE(launch_stage, &record, int(stage), record.stamps[stage]);
+}
+
+void LaunchTrace::commit(const Record &record)
+{
+    const qint64 total = totalNs(record);
+    if (total < 0)
+        return;
+
+#if __has_include(<sys/sdt.h>)
+    const QByteArray appId = record.appId.toUtf8();
+    LAUNCH_TRACE_PROBE(launch_done, appId.constData(), total, record.error);
+#endif
+
+    if (total / 1000000 >= SlowLaunchMs) {
+        QStringList stages;
+        qint64 prev = 0;
+        for (int stage = 0; stage < StageCount; ++stage) {
+            if (!record.stamps[stage])
+                continue;
+
+            if (prev)
+                stages << QString("%1=%2ms").arg(StageNames[stage]).arg(double(record.stamps[stage] - prev) / 1000000, 0, 'f', 1);
+
+            prev = record.stamps[stage];
+        }
+        qWarning() << "slow launch:" << record.appId << "total" << total / 1000000 << "ms," << stages.join(", ");
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_records[m_next] = record;
+    m_next = (m_next + 1) % m_records.size();
+    m_count = std::min(m_count + 1, m_records.size());
+}
+
+QString LaunchTrace::statistics() const
+{
+    std::vector<Record> records;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        records.reserve(m_count);
+        for (size_t i = 0; i < m_count; ++i)
+            records.push_back(m_records[(m_next + m_records.size() - m_count + i) % m_records.size()]);
+    }
+
+    // 阶段耗时为与上一个已记录阶段的时间差
+    struct Durations {
+        Durations() : errors(0) {}
+        std::vector<qint64> stages[StageCount];
+        std::vector<qint64> total;
+        int errors;
+    };
+    QMap<QString, Durations> apps;
+    for (const Record &record : records) {
+        Durations &durations = apps[record.appId];
+        if (record.error)
+            ++durations.errors;
+
+        qint64 prev = 0;
+        for (int stage = 0; stage < StageCount; ++stage) {
+            if (!record.stamps[stage])
+                continue;
+
+            if (prev)
+                durations.stages[stage].push_back(record.stamps[stage] - prev);
+
+            prev = record.stamps[stage];
+        }
+        durations.total.push_back(totalNs(record));
+    }
+
+    QJsonObject appsObj;
+    for (auto iter = apps.begin(); iter != apps.end(); ++iter) {
+        QJsonObject stagesObj;
+        for (int stage = 0; stage < StageCount; ++stage) {
+            if (!iter->stages[stage].empty())
+                stagesObj.insert(StageNames[stage], percentiles(iter->stages[stage]));
+        }
+
+        appsObj.insert(iter.key(), QJsonObject {
+            {"count", int(iter->total.size())},
+            {"errors", iter->errors},
+            {"total", percentiles(iter->total)},
+            {"stages", stagesObj},
+        });
+    }
+
+    return QString::fromUtf8(QJsonDocument(QJsonObject {
+        {"unit", "us"},
+        {"records", int(records.size())},
+        {"apps", appsObj},
+    }).toJson(QJsonDocument::Compact));
+}
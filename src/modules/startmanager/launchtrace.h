@@ -0,0 +1,71 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef LAUNCHTRACE_H
+#define LAUNCHTRACE_H
+
+#include <QString>
+
+#include <mutex>
+#include <vector>
+
+/**
+ * @brief The LaunchTrace class 应用启动各阶段的耗时记录
+ * 每次启动记录各阶段的单调时钟时间戳，完成后放入固定大小的环形缓冲区，
+ * 按应用id统计各阶段耗时的分位数，通过D-Bus调试接口查询。
+ * 超过SlowLaunchMs的启动会打印各阶段耗时；系统提供sys/sdt.h时编译USDT探针，
+ * 可在运行中的守护进程上用bpftrace/perf跟踪，未挂载时没有开销。
+ */
+class LaunchTrace
+{
+public:
+    enum Stage {
+        // StartManager
+        Requested,       // 收到启动请求
+        Admitted,        // 通过内存压力检查
+        Parsed,          // desktop文件解析完成
+        EnvironmentReady,// 环境构建完成(含缩放比例查询)
+        CommandReady,    // Exec展开完成
+        Spawned,         // 子进程exec完成
+        Replied,         // 已回复调用方
+        // ApplicationInstance(loader启动)
+        InstanceCreated, // 创建实例
+        LoaderStarted,   // loader进程或systemd单元已启动
+        TaskSent,        // loader取走启动信息
+        ProcessStarted,  // loader上报应用进程已启动
+        StageCount
+    };
+
+    struct Record {
+        Record();
+
+        QString appId;
+        qint64 stamps[StageCount]; // 单调时钟(ns)，0表示未经过该阶段
+        int error;
+    };
+
+    static LaunchTrace *instance();
+
+    static qint64 now();
+    static const char *stageName(Stage stage);
+    // 记录到达stage的时间
+    static void mark(Record &record, Stage stage);
+
+    // 一次启动结束，保存记录
+    void commit(const Record &record);
+    // 按应用id统计各阶段耗时(us)的p50/p90/p99/max，JSON格式
+    QString statistics() const;
+
+private:
+    LaunchTrace();
+    LaunchTrace(const LaunchTrace &);
+    LaunchTrace& operator= (const LaunchTrace &);
+
+    mutable std::mutex m_mutex;
+    std::vector<Record> m_records; // 环形缓冲区
+    size_t m_next;
+    size_t m_count;
+};
+
+#endif // LAUNCHTRACE_H
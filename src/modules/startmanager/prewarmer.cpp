@@ -0,0 +1,225 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "prewarmer.h"
+#include "basedir.h"
+#include "desktopexec.h"
+#include "desktopinfo.h"
+#include "dstring.h"
+#include "elfdeps.h"
+#include "launchadmission.h"
+#include "startmanagersettings.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTimer>
+#include <QtConcurrent/QtConcurrent>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+namespace {
+
+// 会话开始后多久内的启动计入会话早期
+const qint64 EarlyLaunchMs = 2 * 60 * 1000;
+// 自启动完成后等待的空闲时间
+const int IdleDelayMs = 10 * 1000;
+// 启动记录写回磁盘的延迟
+const int SaveDelayMs = 30 * 1000;
+// 每个应用最多预读的文件数
+const size_t MaxFilesPerApp = 256;
+
+// Exec中的程序名为相对名称时按PATH查找
+std::string findExecutable(const QString &program)
+{
+    const std::string name = program.toStdString();
+    if (name.empty() || name.find('/') != std::string::npos)
+        return name;
+
+    for (const std::string &dir : DString::splitChars(getenv("PATH"), ':')) {
+        const std::string path = dir + "/" + name;
+        if (!access(path.c_str(), X_OK))
+            return path;
+    }
+
+    return std::string();
+}
+
+} // namespace
+
+Prewarmer::Prewarmer(LaunchAdmission *admission, QObject *parent)
+ : QObject(parent)
+ , m_admission(admission)
+ , m_saveTimer(new QTimer(this))
+ , m_cancel(false)
+{
+    m_session.start();
+
+    const std::string cacheDir = BaseDir::userCacheDir();
+    if (!cacheDir.empty())
+        m_historyFile = QString::fromStdString(cacheDir + "deepin/dde-application-manager/launch-history.json");
+
+    m_saveTimer->setSingleShot(true);
+    m_saveTimer->setInterval(SaveDelayMs);
+    connect(m_saveTimer, &QTimer::timeout, this, &Prewarmer::saveHistory);
+
+    // 内存出现压力时中止预读
+    connect(m_admission, &LaunchAdmission::pressureChanged, this, [this](bool pressure) {
+        if (pressure)
+            m_cancel = true;
+    });
+
+    loadHistory();
+}
+
+Prewarmer::~Prewarmer()
+{
+    m_cancel = true;
+    m_future.waitForFinished();
+
+    if (m_saveTimer->isActive())
+        saveHistory();
+}
+
+void Prewarmer::recordLaunch(const QString &desktopFile, qint64 pid)
+{
+    if (pid <= 0)
+        return;
+
+    History &history = m_history[desktopFile];
+    ++history.count;
+    if (m_session.elapsed() < EarlyLaunchMs)
+        ++history.early;
+
+    if (!m_saveTimer->isActive())
+        m_saveTimer->start();
+}
+
+void Prewarmer::schedule()
+{
+    if (!SETTING->getPrewarmEnabled())
+        return;
+
+    QTimer::singleShot(IdleDelayMs, this, &Prewarmer::prewarm);
+}
+
+void Prewarmer::prewarm()
+{
+    if (m_future.isRunning())
+        return;
+
+    if (m_admission->underPressure()) {
+        qInfo() << "prewarm skipped: memory pressure";
+        return;
+    }
+
+    const QStringList apps = hotApps(SETTING->getPrewarmApps());
+    if (apps.isEmpty())
+        return;
+
+    const qint64 budget = qint64(SETTING->getPrewarmBudget()) * 1024 * 1024;
+    m_cancel = false;
+    m_future = QtConcurrent::run([this, apps, budget] {
+        QElapsedTimer timer;
+        timer.start();
+
+        qint64 total = 0;
+        int fileCount = 0;
+        for (const QString &desktopFile : apps) {
+            DesktopInfo info(desktopFile.toStdString());
+            if (!info.isValidDesktop())
+                continue;
+
+            const QStringList args = DesktopExec::cached(QString::fromStdString(info.getCommandLine()))->expand({}, {});
+            const std::string executable = args.isEmpty() ? std::string() : findExecutable(args.first());
+            if (executable.empty())
+                continue;
+
+            for (const std::string &file : ElfDeps::resolve(executable, MaxFilesPerApp)) {
+                if (m_cancel || total >= budget)
+                    break;
+
+                int fd = open(file.c_str(), O_RDONLY | O_CLOEXEC);
+                if (fd < 0)
+                    continue;
+
+                struct stat st;
+                if (!fstat(fd, &st) && total + st.st_size <= budget) {
+                    readahead(fd, 0, size_t(st.st_size));
+                    total += st.st_size;
+                    ++fileCount;
+                }
+                close(fd);
+            }
+        }
+
+        qInfo() << "prewarm" << (m_cancel ? "cancelled" : "finished") << "apps:" << apps.size() << "files:" << fileCount
+                << "bytes:" << total << "in" << timer.elapsed() << "ms";
+    });
+}
+
+// 按会话早期的启动次数排序，其次是总启动次数
+QStringList Prewarmer::hotApps(int count) const
+{
+    QList<QPair<QString, History>> apps;
+    for (auto iter = m_history.constBegin(); iter != m_history.constEnd(); ++iter) {
+        if (iter->early > 0)
+            apps << qMakePair(iter.key(), iter.value());
+    }
+
+    std::sort(apps.begin(), apps.end(), [](const QPair<QString, History> &a, const QPair<QString, History> &b) {
+        return a.second.early != b.second.early ? a.second.early > b.second.early : a.second.count > b.second.count;
+    });
+
+    QStringList result;
+    for (int i = 0; i < apps.size() && i < count; ++i)
+        result << apps[i].first;
+
+    return result;
+}
+
+void Prewarmer::loadHistory()
+{
+    QFile file(m_historyFile);
+    if (m_historyFile.isEmpty() || !file.open(QIODevice::ReadOnly))
+        return;
+
+    const QJsonObject obj = QJsonDocument::fromJson(file.readAll()).object();
+    for (auto iter = obj.constBegin(); iter != obj.constEnd(); ++iter) {
+        const QJsonObject entry = iter.value().toObject();
+        History &history = m_history[iter.key()];
+        history.count = entry.value("count").toInt();
+        history.early = entry.value("early").toInt();
+    }
+}
+
+void Prewarmer::saveHistory()
+{
+    if (m_historyFile.isEmpty())
+        return;
+
+    QJsonObject obj;
+    for (auto iter = m_history.constBegin(); iter != m_history.constEnd(); ++iter) {
+        obj.insert(iter.key(), QJsonObject {
+            {"count", iter->count},
+            {"early", iter->early},
+        });
+    }
+
+    QDir().mkpath(QFileInfo(m_historyFile).absolutePath());
+    QFile file(m_historyFile);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "failed to save launch history:" << file.errorString();
+        return;
+    }
+
+    file.write(QJsonDocument(obj).toJson(QJsonDocument::Compact));
+}
@@ -0,0 +1,61 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef PREWARMER_H
+#define PREWARMER_H
+
+#include <QElapsedTimer>
+#include <QFuture>
+#include <QHash>
+#include <QObject>
+#include <QStringList>
+
+#include <atomic>
+
+class LaunchAdmission;
+class QTimer;
+
+/**
+ * @brief The Prewarmer class 预读常用应用的可执行文件和共享库
+ * 记录每个应用由用户发起的启动次数及在会话开始后EarlyLaunchMs内启动的次数，保存在缓存目录中，
+ * 自启动不计入。
+ * 自启动完成并空闲一段时间后，对会话早期最常启动的应用的可执行文件及其DT_NEEDED依赖
+ * 调用readahead，使之后的启动不必从磁盘读取。
+ * 预读的应用数和字节数有上限，内存有压力时不进行或中止。
+ */
+class Prewarmer : public QObject
+{
+    Q_OBJECT
+public:
+    Prewarmer(LaunchAdmission *admission, QObject *parent = nullptr);
+    ~Prewarmer() override;
+
+public Q_SLOTS:
+    // 记录一次用户发起的成功启动
+    void recordLaunch(const QString &desktopFile, qint64 pid);
+    // 自启动完成后调用，空闲一段时间后开始预读
+    void schedule();
+
+private:
+    struct History {
+        History() : count(0), early(0) {}
+        int count;
+        int early;
+    };
+
+    void prewarm();
+    QStringList hotApps(int count) const;
+    void loadHistory();
+    void saveHistory();
+
+    LaunchAdmission *m_admission;
+    QTimer *m_saveTimer;
+    QElapsedTimer m_session;
+    QString m_historyFile;
+    QHash<QString, History> m_history;
+    std::atomic<bool> m_cancel;
+    QFuture<void> m_future;
+};
+
+#endif // PREWARMER_H
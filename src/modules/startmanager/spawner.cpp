@@ -0,0 +1,205 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "spawner.h"
+
+#include <QDebug>
+#include <QSocketNotifier>
+
+#include <sched.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <thread>
+
+#ifndef SYS_pidfd_open
+#define SYS_pidfd_open 434
+#endif
+
+namespace {
+
+// 子进程栈，execvpe执行脚本时会在栈上复制argv，按参数个数另外增加
+const size_t ChildStackSize = 64 * 1024;
+// 足够容纳pid的十进制表示
+const size_t PidValueSize = 24;
+
+// 子进程使用的全部数据，均在父进程中准备好
+struct ChildArgs {
+    const char *program;
+    char *const *argv;
+    char *const *envp;
+    const char *workingDir;
+    char *pidValue;   // envp中pid环境变量的值，为空时不设置
+    sigset_t mask;    // 父进程原来的信号掩码
+    volatile int error;
+};
+
+// 与父进程共享内存，只能调用异步信号安全的函数
+int childMain(void *data)
+{
+    ChildArgs *args = static_cast<ChildArgs *>(data);
+
+    // 父进程的信号处理函数会改写共享的内存，exec前恢复为默认处理
+    for (int sig = 1; sig < _NSIG; ++sig) {
+        struct sigaction action;
+        if (sigaction(sig, nullptr, &action) < 0
+                || action.sa_handler == SIG_DFL || action.sa_handler == SIG_IGN)
+            continue;
+
+        action.sa_handler = SIG_DFL;
+        action.sa_flags = 0;
+        sigaction(sig, &action, nullptr);
+    }
+    sigprocmask(SIG_SETMASK, &args->mask, nullptr);
+
+    setsid();
+
+    if (args->workingDir[0] && chdir(args->workingDir) < 0) {
+        args->error = errno;
+        _exit(127);
+    }
+
+    if (args->pidValue) {
+        char digits[PidValueSize];
+        size_t len = 0;
+        for (pid_t pid = getpid(); pid > 0 && len < sizeof(digits); pid /= 10)
+            digits[len++] = char('0' + pid % 10);
+
+        for (size_t i = 0; i < len; ++i)
+            args->pidValue[i] = digits[len - 1 - i];
+
+        args->pidValue[len] = '\0';
+    }
+
+    execvpe(args->program, args->argv, args->envp);
+    args->error = errno;
+    _exit(127);
+}
+
+int pidfdOpen(pid_t pid)
+{
+    return int(syscall(SYS_pidfd_open, pid, 0));
+}
+
+} // namespace
+
+Spawner::Spawner(QObject *parent)
+ : QObject(parent)
+{
+
+}
+
+Spawner::~Spawner()
+{
+    for (const Child &child : m_children)
+        close(int(child.notifier->socket()));
+}
+
+pid_t Spawner::spawn(const Command &command, int *error)
+{
+    std::vector<char *> argv;
+    argv.reserve(command.args.size() + 1);
+    for (const std::string &arg : command.args)
+        argv.push_back(const_cast<char *>(arg.c_str()));
+
+    argv.push_back(nullptr);
+
+    // pid变量预留空间，由子进程填入
+    std::vector<std::string> overlay = command.envOverlay;
+    if (!command.pidEnv.empty())
+        overlay.push_back(command.pidEnv + "=" + std::string(PidValueSize, '\0'));
+
+    std::shared_ptr<const EnvironmentBlock> environment = command.environment ? command.environment : EnvironmentBlock::session();
+    std::vector<char *> envp = environment->merge(overlay);
+
+    ChildArgs args;
+    args.program = command.program.c_str();
+    args.argv = argv.data();
+    args.envp = envp.data();
+    args.workingDir = command.workingDir.c_str();
+    args.pidValue = command.pidEnv.empty() ? nullptr : &overlay.back()[command.pidEnv.size() + 1];
+    args.error = 0;
+
+    const size_t stackSize = ChildStackSize + argv.size() * sizeof(char *);
+    void *stack = mmap(nullptr, stackSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK, -1, 0);
+    if (stack == MAP_FAILED) {
+        if (error)
+            *error = errno;
+
+        return -1;
+    }
+
+    // clone返回前不处理任何信号，子进程中再恢复
+    sigset_t all;
+    sigfillset(&all);
+    pthread_sigmask(SIG_BLOCK, &all, &args.mask);
+
+    // CLONE_VFORK: 子进程exec或退出后clone才返回
+    pid_t pid = clone(childMain, static_cast<char *>(stack) + stackSize, CLONE_VM | CLONE_VFORK | SIGCHLD, &args);
+    const int cloneErrno = errno;
+
+    pthread_sigmask(SIG_SETMASK, &args.mask, nullptr);
+    munmap(stack, stackSize);
+
+    if (pid < 0) {
+        if (error)
+            *error = cloneErrno;
+
+        return -1;
+    }
+
+    if (args.error) {
+        waitpid(pid, nullptr, 0);
+        if (error)
+            *error = args.error;
+
+        return -1;
+    }
+
+    watch(pid);
+    return pid;
+}
+
+void Spawner::watch(pid_t pid)
+{
+    int pidfd = pidfdOpen(pid);
+    if (pidfd < 0) {
+        // 内核不支持pidfd(5.3以前)，由单独的线程等待应用退出
+        std::thread([pid] {
+            waitpid(pid, nullptr, 0);
+        }).detach();
+        return;
+    }
+
+    QSocketNotifier *notifier = new QSocketNotifier(pidfd, QSocketNotifier::Read, this);
+    connect(notifier, &QSocketNotifier::activated, this, [this, notifier] {
+        reap(notifier);
+    });
+    m_children.push_back({pid, notifier});
+}
+
+void Spawner::reap(QSocketNotifier *notifier)
+{
+    auto iter = std::find_if(m_children.begin(), m_children.end(), [notifier](const Child &child) {
+        return child.notifier == notifier;
+    });
+    if (iter == m_children.end())
+        return;
+
+    int status = 0;
+    if (waitpid(iter->pid, &status, WNOHANG) == 0)
+        return;
+
+    qDebug() << "app process exited, pid:" << iter->pid << "status:" << status;
+
+    notifier->setEnabled(false);
+    notifier->deleteLater();
+    close(int(notifier->socket()));
+    m_children.erase(iter);
+}
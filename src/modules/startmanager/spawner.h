@@ -0,0 +1,56 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef SPAWNER_H
+#define SPAWNER_H
+
+#include "environmentblock.h"
+
+#include <QObject>
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <sys/types.h>
+
+class QSocketNotifier;
+
+/**
+ * @brief The Spawner class 不复制守护进程地址空间的应用启动器
+ * 使用clone(CLONE_VM | CLONE_VFORK)创建子进程，子进程与守护进程共享内存直到exec，
+ * argv、envp均在父进程中准备好，子进程中只调用异步信号安全的函数。
+ * 应用进程是守护进程的子进程，通过pidfd在事件循环中回收，不再阻塞在waitpid上。
+ * exec是否成功在spawn返回时即可知道。
+ */
+class Spawner : public QObject
+{
+    Q_OBJECT
+public:
+    struct Command {
+        std::string program;
+        std::vector<std::string> args;   // 包括argv[0]
+        std::shared_ptr<const EnvironmentBlock> environment; // 为空时使用会话环境
+        std::vector<std::string> envOverlay; // KEY=VALUE，替换或追加到environment中
+        std::string workingDir;
+        std::string pidEnv;              // 非空时在子进程中追加该环境变量，值为应用pid
+    };
+
+    explicit Spawner(QObject *parent = nullptr);
+    ~Spawner();
+
+    // 成功返回应用pid，exec失败时返回-1并通过error给出errno
+    pid_t spawn(const Command &command, int *error = nullptr);
+
+private:
+    void watch(pid_t pid);
+    void reap(QSocketNotifier *notifier);
+
+    struct Child {
+        pid_t pid;
+        QSocketNotifier *notifier;
+    };
+    std::vector<Child> m_children;
+};
+
+#endif // SPAWNER_H
@@ -7,14 +7,16 @@
 #include "dfile.h"
 #include "common.h"
 #include "desktopinfo.h"
+#include "desktopexec.h"
 #include "startmanagersettings.h"
 #include "startmanagerdbushandler.h"
-#include "meminfo.h"
+#include "spawner.h"
+#include "environmentblock.h"
+#include "launchtrace.h"
+#include "launchadmission.h"
+#include "prewarmer.h"
 #include "../../service/impl/application_manager.h"
 
-#include <sys/wait.h>
-#include <wordexp.h>
-
 #include <QFileSystemWatcher>
 #include <QDebug>
 #include <QDir>
@@ -22,26 +24,79 @@
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QTimer>
+#include <QDeadlineTimer>
 #include <QThread>
 #include <QDBusConnection>
 #include <QDBusReply>
+#include <QFutureWatcher>
+#include <QtConcurrent/QtConcurrent>
 
 #define DESKTOPEXT ".desktop"
 #define SETTING StartManagerSettings::instance()
 
+struct StartManager::LaunchTask {
+    LaunchTask() : timestamp(0), autostart(false), useProxy(false), error(0), finished(false), pid(-1) {}
+
+    QString desktopFile;
+    QString action; // 非空时启动对应的Desktop Action
+    uint32_t timestamp;
+    QStringList files;
+    QVariantMap options;
+    LaunchCallback callback;
+    bool autostart; // 由自启动调度发起，不计入预读的启动记录
+
+    // 主线程中读取的配置
+    QVector<QString> useProxyApps;
+    QVector<QString> disableScalingApps;
+    QString terminalExec;
+    QString terminalExecArg;
+
+    // 解析结果
+    Spawner::Command command;
+    bool useProxy;
+    int error;
+
+    LaunchTrace::Record trace;
+
+    // 合并重复请求，窗口内相同key的请求共用本次启动的结果
+    QString coalesceKey;
+    QDeadlineTimer coalesceDeadline;
+    std::vector<LaunchCallback> coalesced;
+    bool finished;
+    qint64 pid;
+};
+
 StartManager::StartManager(QObject *parent)
     : QObject(parent)
     , minMemAvail(0)
     , maxSwapUsed(0)
     , dbusHandler(new StartManagerDBusHandler(this))
+    , m_spawner(new Spawner(this))
+    , m_autostartScheduler(new AutostartScheduler(this))
+    , m_admission(new LaunchAdmission(this))
+    , m_prewarmer(new Prewarmer(m_admission, this))
+    , m_scaleFactor(0)
     , m_autostartFileWatcher(new QFileSystemWatcher(this))
-    , m_autostartFiles(getAutostartList())
     , m_isDBusCalled(false)
 {
+    connect(dbusHandler, &StartManagerDBusHandler::scaleFactorChanged, this, [this](double scale) {
+        m_scaleFactor = scale;
+    });
+    connect(SETTING, &StartManagerSettings::scaleFactorChanged, dbusHandler, &StartManagerDBusHandler::requestScaleFactor);
+    dbusHandler->requestScaleFactor();
+
+    // 自启动完成后预读常用应用，启动次数在finishLaunch中记录
+    connect(m_autostartScheduler, &AutostartScheduler::finished, m_prewarmer, &Prewarmer::schedule);
+
+    // 扫描自启动目录时一并读取调度信息，启动前不再重复解析
+    QList<AutostartEntry> autostartEntries;
+    m_autostartFiles = getAutostartList(&autostartEntries);
+
     loadSysMemLimitConfig();
+    m_admission->setLimits(minMemAvail, maxSwapUsed);
     getDesktopToAutostartMap();
     listenAutostartFileEvents();
-    startAutostartProgram();
+    startAutostartProgram(autostartEntries);
 }
 
 bool StartManager::addAutostart(const QString &desktop)
@@ -95,55 +150,55 @@ bool StartManager::isAutostart(const QString &desktop)
 
 bool StartManager::isMemSufficient()
 {
-    return SETTING->getMemCheckerEnabled() ? MemInfo::isSufficient(minMemAvail, maxSwapUsed) : true;
+    return SETTING->getMemCheckerEnabled() ? !m_admission->underPressure() : true;
 }
 
-bool StartManager::launchApp(const QString &desktopFile)
+void StartManager::launchApp(const QString &desktopFile, LaunchCallback callback)
 {
-    return doLaunchAppWithOptions(desktopFile);
+    QSharedPointer<LaunchTask> task(new LaunchTask);
+    task->desktopFile = desktopFile;
+    task->callback = callback;
+    startLaunch(task);
 }
 
-bool StartManager::launchApp(QString desktopFile, uint32_t timestamp, QStringList files)
+void StartManager::launchAutostartApp(const QString &desktopFile, LaunchCallback callback)
 {
-    return doLaunchAppWithOptions(desktopFile, timestamp, files, QVariantMap());
+    QSharedPointer<LaunchTask> task(new LaunchTask);
+    task->desktopFile = desktopFile;
+    task->callback = callback;
+    task->autostart = true;
+    startLaunch(task);
 }
 
-bool StartManager::launchAppAction(QString desktopFile, QString actionSection, uint32_t timestamp)
+void StartManager::launchApp(QString desktopFile, uint32_t timestamp, QStringList files, LaunchCallback callback)
 {
-    DesktopInfo info(desktopFile.toStdString());
-    if (!info.isValidDesktop()) {
-        qWarning() << "invalid arguments";
-        return false;
-    }
-
-    DesktopAction targetAction;
-    for (auto action : info.getActions()) {
-        if (!action.section.empty() && action.section.c_str() == actionSection) {
-            targetAction = action;
-            break;
-        }
-    }
-
-    if (targetAction.section.empty()) {
-        qWarning() << "launchAppAction: targetAction section is empty";
-        return false;
-    }
-
-    if (targetAction.exec.empty()) {
-        qInfo() << "launchAppAction: targetAction exe is empty";
-        return false;
-    }
-
-    launch(&info, targetAction.exec.c_str(), timestamp, QStringList());
+    QSharedPointer<LaunchTask> task(new LaunchTask);
+    task->desktopFile = desktopFile;
+    task->timestamp = timestamp;
+    task->files = files;
+    task->callback = callback;
+    startLaunch(task);
+}
 
-    // mark app launched
-    dbusHandler->markLaunched(desktopFile);
-    return true;
+void StartManager::launchAppAction(QString desktopFile, QString actionSection, uint32_t timestamp, LaunchCallback callback)
+{
+    QSharedPointer<LaunchTask> task(new LaunchTask);
+    task->desktopFile = desktopFile;
+    task->action = actionSection;
+    task->timestamp = timestamp;
+    task->callback = callback;
+    startLaunch(task);
 }
 
-bool StartManager::launchAppWithOptions(QString desktopFile, uint32_t timestamp, QStringList files, QVariantMap options)
+void StartManager::launchAppWithOptions(QString desktopFile, uint32_t timestamp, QStringList files, QVariantMap options, LaunchCallback callback)
 {
-    return doLaunchAppWithOptions(desktopFile, timestamp, files, options);
+    QSharedPointer<LaunchTask> task(new LaunchTask);
+    task->desktopFile = desktopFile;
+    task->timestamp = timestamp;
+    task->files = files;
+    task->options = options;
+    task->callback = callback;
+    startLaunch(task);
 }
 
 bool StartManager::runCommand(QString exe, QStringList args)
@@ -323,119 +378,194 @@ bool StartManager::setAutostart(const QString &desktop, const bool value)
    return true;
 }
 
-bool StartManager::doLaunchAppWithOptions(const QString &desktopFile)
+/**
+ * @brief StartManager::startLaunch 启动流程: 解析 -> 构建环境 -> 创建进程 -> 上报
+ * 解析desktop文件、展开Exec及需要等待D-Bus的环境构建在线程池中进行，
+ * 创建进程和上报回到主线程，一个慢的依赖不会让其它启动请求排队等待
+ */
+void StartManager::startLaunch(const QSharedPointer<LaunchTask> &task)
 {
-    DesktopInfo info(desktopFile.toStdString());
-    if (!info.isValidDesktop()) {
-        qWarning() << "invalid desktop path";
-        return false;
-    }
+    if (coalesceLaunch(task))
+        return;
 
-    launch(&info, QString::fromStdString(info.getCommandLine()), 0, QStringList());
+    // 解析成功前以desktop文件路径作为应用id
+    task->trace.appId = task->desktopFile;
+    LaunchTrace::mark(task->trace, LaunchTrace::Requested);
 
-    dbusHandler->markLaunched(desktopFile);
+    // 内存压力大时推迟启动，压力解除或等待超时后继续
+    if (!SETTING->getMemCheckerEnabled()) {
+        dispatchLaunch(task);
+        return;
+    }
 
-    return true;
+    m_admission->admit([this, task] {
+        dispatchLaunch(task);
+    }, maxLaunchDeferMs);
 }
 
-bool StartManager::doLaunchAppWithOptions(QString desktopFile, uint32_t timestamp, QStringList files, QVariantMap options)
+/**
+ * @brief StartManager::coalesceLaunch 合并重复的启动请求
+ * 任务栏和启动器同时响应、双击等情况下，窗口期内desktop文件、action和文件列表都相同的请求只启动一次，
+ * 所有调用方得到同一个pid。带options的请求不合并。
+ * @return 已合并到之前的请求时返回true
+ */
+bool StartManager::coalesceLaunch(const QSharedPointer<LaunchTask> &task)
 {
-    // launchApp
-    DesktopInfo info(desktopFile.toStdString());
-    if (!info.isValidDesktop()) {
-        qWarning() << "invalid desktop path";
+    const int window = SETTING->getLaunchCoalesceWindow();
+    if (window <= 0 || !task->options.isEmpty())
         return false;
-    }
 
-    if (options.find("path") != options.end()) {
-        info.getDesktopFile()->setKey(MainSection, KeyPath, options["path"].toString().toStdString());
-    }
+    const QString key = task->desktopFile + QChar(0) + task->action + QChar(0) + task->files.join(QChar(0));
+    auto iter = m_coalescing.constFind(key);
+    if (iter != m_coalescing.constEnd() && !iter.value()->coalesceDeadline.hasExpired()) {
+        const QSharedPointer<LaunchTask> &first = iter.value();
+        qInfo() << "duplicate launch request coalesced:" << task->desktopFile;
+        if (!first->finished) {
+            if (task->callback)
+                first->coalesced.push_back(task->callback);
+        } else if (task->callback) {
+            task->callback(first->pid, first->error);
+        }
 
-    if (options.find("desktop-override-exec") != options.end()) {
-        info.setDesktopOverrideExec(options["desktop-override-exec"].toString().toStdString());
+        return true;
     }
 
-    if (info.getCommandLine().empty()) {
-        qWarning() << "command line is empty";
-        return false;
+    task->coalesceKey = key;
+    task->coalesceDeadline = QDeadlineTimer(window);
+    m_coalescing.insert(key, task);
+    return false;
+}
+
+void StartManager::dispatchLaunch(const QSharedPointer<LaunchTask> &task)
+{
+    LaunchTrace::mark(task->trace, LaunchTrace::Admitted);
+
+    // DConfig只在主线程中访问
+    task->useProxyApps = SETTING->getUseProxyApps();
+    task->disableScalingApps = SETTING->getDisableScalingApps();
+    task->terminalExec = SETTING->getDefaultTerminalExec();
+    task->terminalExecArg = SETTING->getDefaultTerminalExecArg();
+
+    QFutureWatcher<void> *watcher = new QFutureWatcher<void>(this);
+    connect(watcher, &QFutureWatcher<void>::finished, this, [this, watcher, task] {
+        watcher->deleteLater();
+        finishLaunch(task);
+    });
+    watcher->setFuture(QtConcurrent::run([this, task] {
+        resolveLaunch(*task);
+    }));
+}
+
+// 在工作线程中执行，只能访问task中的数据
+void StartManager::resolveLaunch(LaunchTask &task)
+{
+    DesktopInfo info(task.desktopFile.toStdString());
+    if (!info.isValidDesktop()) {
+        qWarning() << "invalid desktop path:" << task.desktopFile;
+        task.error = EINVAL;
+        return;
     }
 
-    launch(&info,  QString::fromStdString(info.getCommandLine()), timestamp, files);
+    if (!info.getId().empty())
+        task.trace.appId = QString::fromStdString(info.getId());
+
+    QString cmdLine;
+    if (!task.action.isEmpty()) {
+        DesktopAction targetAction;
+        for (auto action : info.getActions()) {
+            if (!action.section.empty() && action.section.c_str() == task.action) {
+                targetAction = action;
+                break;
+            }
+        }
+
+        if (targetAction.section.empty()) {
+            qWarning() << "launchAppAction: targetAction section is empty";
+            task.error = EINVAL;
+            return;
+        }
 
-    // mark app launched
-    dbusHandler->markLaunched(desktopFile);
+        if (targetAction.exec.empty()) {
+            qInfo() << "launchAppAction: targetAction exe is empty";
+            task.error = EINVAL;
+            return;
+        }
 
-    return true;
+        cmdLine = QString::fromStdString(targetAction.exec);
+    } else {
+        if (task.options.find("path") != task.options.end()) {
+            info.getDesktopFile()->setKey(MainSection, KeyPath, task.options["path"].toString().toStdString());
+        }
+
+        if (task.options.find("desktop-override-exec") != task.options.end()) {
+            info.setDesktopOverrideExec(task.options["desktop-override-exec"].toString().toStdString());
+        }
+
+        if (info.getCommandLine().empty()) {
+            qWarning() << "command line is empty";
+            task.error = EINVAL;
+            return;
+        }
+
+        cmdLine = QString::fromStdString(info.getCommandLine());
+    }
+
+    LaunchTrace::mark(task.trace, LaunchTrace::Parsed);
+    if (!buildCommand(task, &info, cmdLine))
+        task.error = EINVAL;
 }
 
-void StartManager::launch(DesktopInfo *info, QString cmdLine, uint32_t timestamp, QStringList files)
+bool StartManager::buildCommand(LaunchTask &task, DesktopInfo *info, const QString &cmdLine)
 {
-    // NOTE(black_desk): this function do not return the result. If this feature
-    // needed someday, we should use pipe to let that double forked child
-    // process to report the return value of execvpe.
-
-    QProcess process; // NOTE(black_desk): this QProcess not used to start, we
-                      // have to manually fork and exec to set
-                      // GIO_LAUNCHED_DESKTOP_FILE_PID.
-    QStringList cmdPrefixesEnvs;
-    QProcessEnvironment envs = QProcessEnvironment::systemEnvironment();
     QString appId(QString::fromStdString(info->getId()));
+    Spawner::Command &command = task.command;
 
-    bool useProxy = shouldUseProxy(appId);
-    if (useProxy) {
-        envs.remove("auto_proxy");
-        envs.remove("AUTO_PROXY");
-        envs.remove("http_proxy");
-        envs.remove("HTTP_PROXY");
-        envs.remove("https_proxy");
-        envs.remove("HTTPS_PROXY");
-        envs.remove("ftp_proxy");
-        envs.remove("FTP_PROXY");
-        envs.remove("SOCKS_SERVER");
-        envs.remove("no_proxy");
-        envs.remove("NO_PROXY");
-    }
+    // 会话环境只生成一次，这里只记录每次启动不同的变量
+    bool useProxy = shouldUseProxy(task, appId);
+    command.environment = useProxy ? EnvironmentBlock::sessionWithoutProxy() : EnvironmentBlock::session();
 
     // FIXME: Don't using env to control the window scale factor,  this function
     // should via using graphisc server(Wayland Compositor/Xorg Xft) in deepin wine.
-    if (!appId.isEmpty() && !shouldDisableScaling(appId)) {
-        auto dbus = QDBusConnection::sessionBus();
-        QDBusMessage reply = dbus.call(QDBusMessage::createMethodCall("org.deepin.dde.XSettings1",
-                                                                      "/org/deepin/dde/XSettings1",
-                                                                      "org.deepin.dde.XSettings1",
-                                                                      "GetScaleFactor"), QDBus::Block, 2);
-
-        if (reply.type() == QDBusMessage::ReplyMessage) {
-            QDBusReply<double> ret(reply);
-            double scale = ret.isValid() ? ret.value() : 1.0;
-            scale = scale > 0 ? scale : 1;
+    if (!appId.isEmpty() && !task.disableScalingApps.contains(appId)) {
+        // 缩放比例缓存在内存中，只有还没获取到时才同步查询
+        double scale = m_scaleFactor.load();
+        if (scale <= 0) {
+            scale = dbusHandler->getScaleFactor();
+            double unknown = 0;
+            if (scale > 0)
+                m_scaleFactor.compare_exchange_strong(unknown, scale);
+        }
+
+        if (scale > 0) {
             const QString scaleStr = QString::number(scale, 'f', -1);
-            envs.insert("DEEPIN_WINE_SCALE", scaleStr);
+            command.envOverlay.push_back("DEEPIN_WINE_SCALE=" + scaleStr.toStdString());
         }
     }
 
-    QStringList exeArgs;
+    LaunchTrace::mark(task.trace, LaunchTrace::EnvironmentReady);
 
-    auto stdCmdLine = cmdLine.toStdString();
-    wordexp_t words;
-    auto ret = wordexp(stdCmdLine.c_str(), &words, 0);
-    if (ret != 0) {
-        qCritical() << "wordexp failed, error code:" << ret;
-        wordfree(&words);
-        return;
-    }
-
-    for (int i = 0; i < (int)words.we_wordc; i++) {
-        exeArgs << words.we_wordv[i];
+    // Exec按规范分词，解析结果按命令行缓存，不再经过wordexp和shell
+    std::shared_ptr<const DesktopExec> desktopExec = DesktopExec::cached(cmdLine);
+    if (!desktopExec->isValid()) {
+        qCritical() << "invalid exec, command line:" << cmdLine;
+        return false;
     }
 
-    wordfree(&words);
-
-    handleRecognizeArgs(exeArgs, files);
+    DesktopExec::Entry entry;
+    entry.icon = QString::fromStdString(info->getIcon());
+    entry.name = QString::fromStdString(info->getName());
+    entry.filePath = QString::fromStdString(info->getDesktopFile()->getFilePath());
+    QStringList exeArgs = desktopExec->expand(task.files, entry);
+    LaunchTrace::mark(task.trace, LaunchTrace::CommandReady);
 
     if (info->getTerminal()) {
-        exeArgs.insert(0, SETTING->getDefaultTerminalExecArg());
-        exeArgs.insert(0, SETTING->getDefaultTerminalExec());
+        exeArgs.insert(0, task.terminalExecArg);
+        exeArgs.insert(0, task.terminalExec);
+    }
+
+    if (exeArgs.isEmpty()) {
+        qWarning() << "exec is empty, command line:" << cmdLine;
+        return false;
     }
 
     std::string workingDir = info->getDesktopFile()->getStr(MainSection, KeyPath);
@@ -447,65 +577,78 @@ void StartManager::launch(DesktopInfo *info, QString cmdLine, uint32_t timestamp
     exeArgs.removeAt(0);
 
     qDebug() << "Launching app, desktop:" << QString::fromStdString(info->getFileName()) << "exec:" << exec
-             << "args:" << exeArgs << "useProxy:" << useProxy << "appid:" << appId << "envs:" << envs.toStringList();
+             << "args:" << exeArgs << "useProxy:" << useProxy << "appid:" << appId;
 
-    process.setProgram(exec);
-    process.setArguments(exeArgs);
-    process.setWorkingDirectory(workingDir.c_str());
+    command.envOverlay.push_back("GIO_LAUNCHED_DESKTOP_FILE=" + info->getDesktopFile()->getFilePath());
 
-    // NOTE(black_desk): This have to be done after load system environment.
-    // Set same env twice in qt make the first one gone.
-    envs.insert("GIO_LAUNCHED_DESKTOP_FILE", QString::fromStdString(info->getDesktopFile()->getFilePath()));
+    // argv在这里准备好，GIO_LAUNCHED_DESKTOP_FILE_PID由子进程在exec前填入
+    command.program = exec.toLocal8Bit().toStdString();
+    command.args.push_back(command.program);
+    for (const QString &arg : exeArgs)
+        command.args.push_back(arg.toStdString());
 
-    qint64 pid = fork();
-    if (pid == -1){
-        qCritical() << "failed to fork, errno" << errno;
-        return;
-    } else if (pid == 0) {
-        // process to exit after vfork exec success.
-        qint64 doubleForkPID = fork();
-        if (doubleForkPID == -1) {
-            // qCritical() << "failed to fork, errno" << errno;
-            exit(-1);
-        } else if (doubleForkPID == 0) {
-            // App process
-            envs.insert("GIO_LAUNCHED_DESKTOP_FILE_PID", QByteArray::number(getpid()).constData());
-            auto argList = process.arguments();
-            char const * args[argList.length() + 2];
-            std::transform(argList.constBegin(), argList.constEnd(), args + 1, [](const QString& str){
-                auto byte = new QByteArray;
-                *byte = str.toUtf8();
-                auto tmp_buf = byte->data();
-                return tmp_buf;
-            });
-            auto arg0 = process.program().toLocal8Bit();
-            args[0] = arg0.constData();
-            args[process.arguments().length() + 1] = 0;
-            auto envStringList = envs.toStringList();
-            char const * envs[envStringList.length() + 1];
-            std::transform(envStringList.constBegin(), envStringList.constEnd(), envs, [](const QString& str){
-                auto byte = new QByteArray;
-                *byte = str.toUtf8();
-                auto tmp_buf = byte->data();
-                return tmp_buf;
-            });
-            envs[envStringList.length()] = 0;
-            ::execvpe(arg0.constData(), (char**)args, (char**)envs);
-            // qCritical() <<"failed to execve app, errno" << errno;
-            _exit(-1);
-        }
-        // qDebug() << "double fork pid:" << doubleForkPID;
-        _exit(0);
-    } else {
+    command.workingDir = workingDir;
+    command.pidEnv = "GIO_LAUNCHED_DESKTOP_FILE_PID";
+
+    task.useProxy = useProxy;
+    return true;
+}
+
+void StartManager::finishLaunch(const QSharedPointer<LaunchTask> &task)
+{
+    qint64 pid = -1;
+    int error = task->error;
+    if (!error) {
+        pid = m_spawner->spawn(task->command, &error);
+        if (pid < 0)
+            qCritical() << "failed to launch app, desktop:" << task->desktopFile << "errno" << error;
+        else
+            LaunchTrace::mark(task->trace, LaunchTrace::Spawned);
+    }
+
+    if (pid > 0) {
         qDebug() << "pid:" << pid;
-        waitpid(pid, nullptr, 0);
-        if (useProxy) {
+        if (task->useProxy) {
             qDebug() << "Launch the process[" << pid << "] by app proxy.";
-            dbusHandler->addProxyProc(pid);
+            dbusHandler->addProxyProc(int32_t(pid));
         }
-        return;
+
+        // mark app launched
+        dbusHandler->markLaunched(task->desktopFile);
+    }
+
+    if (task->callback)
+        task->callback(pid, error);
+
+    for (const LaunchCallback &callback : task->coalesced)
+        callback(pid, error);
+
+    task->coalesced.clear();
+    task->finished = true;
+    task->pid = pid;
+    task->error = error;
+    if (!task->coalesceKey.isEmpty()) {
+        // 窗口期结束后移除，之后的请求重新启动
+        auto remove = [this, task] {
+            if (m_coalescing.value(task->coalesceKey) == task)
+                m_coalescing.remove(task->coalesceKey);
+        };
+
+        if (task->coalesceDeadline.hasExpired())
+            remove();
+        else
+            QTimer::singleShot(int(task->coalesceDeadline.remainingTime()), this, remove);
     }
-    return;
+
+    LaunchTrace::mark(task->trace, LaunchTrace::Replied);
+    task->trace.error = error;
+    LaunchTrace::instance()->commit(task->trace);
+
+    // 自启动的应用在预读时已经在运行，只统计用户发起的启动
+    if (!task->autostart)
+        m_prewarmer->recordLaunch(task->desktopFile, pid);
+
+    Q_EMIT launchFinished(task->desktopFile, pid);
 }
 
 bool StartManager::doRunCommandWithOptions(QString exe, QStringList args, QVariantMap options)
@@ -523,10 +666,9 @@ void StartManager::waitCmd(DesktopInfo *info, QProcess *process, QString cmdName
 
 }
 
-bool StartManager::shouldUseProxy(QString appId)
+bool StartManager::shouldUseProxy(const LaunchTask &task, const QString &appId)
 {
-    auto useProxyApps = SETTING->getUseProxyApps();
-    if (!useProxyApps.contains(appId))
+    if (!task.useProxyApps.contains(appId))
         return false;
 
     if (dbusHandler->getProxyMsg().isEmpty())
@@ -535,12 +677,6 @@ bool StartManager::shouldUseProxy(QString appId)
     return true;
 }
 
-bool StartManager::shouldDisableScaling(QString appId)
-{
-    auto disableScalingApps = SETTING->getDisableScalingApps();
-    return disableScalingApps.contains(appId);
-}
-
 void StartManager::loadSysMemLimitConfig()
 {
     std::string configPath = BaseDir::userConfigDir() + "deepin/startdde/memchecker.json";
@@ -575,18 +711,12 @@ void StartManager::listenAutostartFileEvents()
     connect(m_autostartFileWatcher, &QFileSystemWatcher::directoryChanged, this, &StartManager::onAutoStartupPathChange, Qt::QueuedConnection);
 }
 
-void StartManager::startAutostartProgram()
+void StartManager::startAutostartProgram(const QList<AutostartEntry> &entries)
 {
-    for (const QString &desktopFile : autostartList()) {
-        DesktopInfo info(desktopFile.toStdString());
-        if (!info.isValidDesktop())
-            continue;
-
-        launchApp(desktopFile);
-    }
+    m_autostartScheduler->start(entries, SETTING->getAutostartDelay(), SETTING->getAutostartParallel());
 }
 
-QStringList StartManager::getAutostartList()
+QStringList StartManager::getAutostartList(QList<AutostartEntry> *entries)
 {
     QStringList autostartList;
     for (const std::string &autostartDir : BaseDir::autoStartDirs()) {
@@ -601,19 +731,19 @@ QStringList StartManager::getAutostartList()
                 continue;
 
             // 需要检查desktop文件中的Hidden,OnlyShowIn和NotShowIn字段,再决定是否需要自启动
-            auto isNeedAutoStart = [ ](const std::string &_fileName){
-                DesktopInfo info(_fileName);
-                if (!info.isValidDesktop())
-                    return false;
+            DesktopInfo info(entry.absoluteFilePath().toStdString());
+            if (!info.isValidDesktop())
+                continue;
 
-                if (info.getIsHidden())
-                    return false;
+            if (info.getIsHidden())
+                continue;
 
-                return info.getShowIn(std::vector<std::string>());
-            };
+            if (!info.getShowIn(std::vector<std::string>()))
+                continue;
 
-            if (isNeedAutoStart(entry.absoluteFilePath().toStdString()))
-                autostartList.push_back(entry.absoluteFilePath());
+            autostartList.push_back(entry.absoluteFilePath());
+            if (entries)
+                entries->push_back(AutostartEntry::fromDesktop(info, entry.absoluteFilePath()));
         }
     }
 
@@ -654,50 +784,3 @@ bool StartManager::isDBusCalled() const
 {
     return m_isDBusCalled;
 }
-
-/**遵循 freedesktop 规范，添加识别的字段处理
- * @brief StartManager::hangleRecognizeArgs
- * @param exeArgs desktop文件中 exec 字段对应的内容
- * @param files 启动应用的路径列表
- */
-void StartManager::handleRecognizeArgs(QStringList &exeArgs, QStringList files)
-{
-    QStringList argList;
-    argList << "%f" << "%F" << "%u" << "%U" << "%i" << "%c" << "%k";
-
-    // https://specifications.freedesktop.org/desktop-entry-spec/desktop-entry-spec-latest.html#exec-variables
-
-    // > If the application should not open any file the %f, %u, %F and %U field
-    // > codes must be removed from the command line and ignored.
-
-    if (files.isEmpty()) {
-        for (const QString &arg : argList) {
-            exeArgs.removeAll(arg);
-        }
-        return;
-    }
-
-    // 若 Recognized field codes 并非单独出现, 而是出现在引号中, 应该如何对其进行替换.
-    // 这一点在XDG spec中似乎并没有详细的说明.
-
-    if (!exeArgs.filter("%f").isEmpty()) {
-        // > A single file name (including the path), even if multiple files are selected.
-        exeArgs.replaceInStrings("%f", files.at(0));
-    } else if (!exeArgs.filter("%F").isEmpty()) {
-        exeArgs.removeOne("%F");
-        for (const QString &file : files) {
-            QUrl url(file);
-            exeArgs << url.toLocalFile();
-        }
-    } else if (!exeArgs.filter("%u").isEmpty()) {
-        exeArgs.replaceInStrings("%u", files.at(0));
-    } else if (!exeArgs.filter("%U").isEmpty()) {
-        exeArgs.replaceInStrings("%U", files.join(" "));
-    } else if (!exeArgs.filter("%i").isEmpty()) {
-        // TODO: 待出现这个类型的问题时再行适配，优先解决阻塞问题
-    } else if (!exeArgs.filter("%c").isEmpty()) {
-        // TODO: 待出现这个类型的问题时再行适配，优先解决阻塞问题
-    } else if (!exeArgs.filter("%k").isEmpty()) {
-        // TODO: 待出现这个类型的问题时再行适配，优先解决阻塞问题
-    }
-}
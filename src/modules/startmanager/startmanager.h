@@ -5,11 +5,21 @@
 #ifndef STARTMANAGER_H
 #define STARTMANAGER_H
 
+#include "autostartscheduler.h"
+
 #include <QObject>
+#include <QHash>
 #include <QMap>
+#include <QSharedPointer>
+
+#include <atomic>
+#include <functional>
 
 class AppLaunchContext;
 class StartManagerDBusHandler;
+class Spawner;
+class LaunchAdmission;
+class Prewarmer;
 class DesktopInfo;
 class QProcess;
 class QFileSystemWatcher;
@@ -19,6 +29,9 @@ class StartManager : public QObject
 {
     Q_OBJECT
 public:
+    // 启动完成的回调，失败时pid为-1，error为errno(desktop文件或参数无效时为EINVAL)
+    typedef std::function<void(qint64 pid, int error)> LaunchCallback;
+
     explicit StartManager(QObject *parent = nullptr);
 
     bool addAutostart(const QString &desktop);
@@ -26,41 +39,54 @@ public:
     QStringList autostartList();
     bool isAutostart(const QString &desktop);
     bool isMemSufficient();
-    bool launchApp(const QString &desktopFile);
-    bool launchApp(QString desktopFile, uint32_t timestamp, QStringList files);
-    bool launchAppAction(QString desktopFile, QString actionSection, uint32_t timestamp);
-    bool launchAppWithOptions(QString desktopFile, uint32_t timestamp, QStringList files, QVariantMap options);
+    // 启动均为异步，完成后调用callback并发出launchFinished
+    void launchApp(const QString &desktopFile, LaunchCallback callback = nullptr);
+    // 自启动调度使用，不计入常用应用的启动记录
+    void launchAutostartApp(const QString &desktopFile, LaunchCallback callback);
+    void launchApp(QString desktopFile, uint32_t timestamp, QStringList files, LaunchCallback callback = nullptr);
+    void launchAppAction(QString desktopFile, QString actionSection, uint32_t timestamp, LaunchCallback callback = nullptr);
+    void launchAppWithOptions(QString desktopFile, uint32_t timestamp, QStringList files, QVariantMap options, LaunchCallback callback = nullptr);
     bool runCommand(QString exe, QStringList args);
     bool runCommandWithOptions(QString exe, QStringList args, QVariantMap options);
 
 Q_SIGNALS:
     void autostartChanged(const QString &status, const QString &fileName);
+    void launchFinished(const QString &desktopFile, qint64 pid);
 
 public Q_SLOTS:
     void onAutoStartupPathChange(const QString &dirPath);
 
 private:
     bool setAutostart(const QString &fileName, const bool value);
-    bool doLaunchAppWithOptions(const QString &desktopFile);
-    bool doLaunchAppWithOptions(QString desktopFile, uint32_t timestamp, QStringList files, QVariantMap options);
-    void launch(DesktopInfo *info, QString cmdLine, uint32_t timestamp, QStringList files);
+    struct LaunchTask;
+    void startLaunch(const QSharedPointer<LaunchTask> &task);
+    bool coalesceLaunch(const QSharedPointer<LaunchTask> &task);
+    void dispatchLaunch(const QSharedPointer<LaunchTask> &task);
+    void resolveLaunch(LaunchTask &task);
+    bool buildCommand(LaunchTask &task, DesktopInfo *info, const QString &cmdLine);
+    void finishLaunch(const QSharedPointer<LaunchTask> &task);
     bool doRunCommandWithOptions(QString exe, QStringList args, QVariantMap options);
     void waitCmd(DesktopInfo *info, QProcess *process, QString cmdName);
-    bool shouldUseProxy(QString appId);
-    bool shouldDisableScaling(QString appId);
+    bool shouldUseProxy(const LaunchTask &task, const QString &appId);
     void loadSysMemLimitConfig();
     QStringList getDefaultTerminal();
     void listenAutostartFileEvents();
-    void startAutostartProgram();
-    QStringList getAutostartList();
+    void startAutostartProgram(const QList<AutostartEntry> &entries);
+    // entries非空时同时读取各自启动项的调度信息
+    QStringList getAutostartList(QList<AutostartEntry> *entries = nullptr);
     QMap<QString, QString> getDesktopToAutostartMap();
     void setIsDBusCalled(const bool state);
     bool isDBusCalled() const;
-    void handleRecognizeArgs(QStringList &exeArgs, QStringList files);
 
     uint64_t minMemAvail;
     uint64_t maxSwapUsed;
     StartManagerDBusHandler *dbusHandler;
+    Spawner *m_spawner;
+    AutostartScheduler *m_autostartScheduler;
+    LaunchAdmission *m_admission;
+    Prewarmer *m_prewarmer;
+    QHash<QString, QSharedPointer<LaunchTask>> m_coalescing; // 合并窗口内的启动请求
+    std::atomic<double> m_scaleFactor; // XSettings缩放比例，0表示尚未获取
     QStringList m_autostartFiles;
     QMap<QString, QString> m_desktopDirToAutostartDirMap;   // Desktop全路径和自启动目录
     QFileSystemWatcher *m_autostartFileWatcher;
@@ -5,18 +5,39 @@
 #include "startmanagerdbushandler.h"
 
 #include <QDBusInterface>
+#include <QDebug>
 #include <QDBusReply>
+#include <QDBusMessage>
+#include <QDBusPendingCallWatcher>
+#include <QDBusPendingReply>
+#include <QDBusServiceWatcher>
+
+#define XSETTINGS_SERVICE "org.deepin.dde.XSettings1"
+#define XSETTINGS_PATH "/org/deepin/dde/XSettings1"
+#define XSETTINGS_INTERFACE "org.deepin.dde.XSettings1"
 
 StartManagerDBusHandler::StartManagerDBusHandler(QObject *parent)
  : QObject(parent)
 {
+    // 缩放比例设置完成或XSettings服务重新启动后重新获取
+    QDBusConnection::sessionBus().connect(XSETTINGS_SERVICE,
+                                          XSETTINGS_PATH,
+                                          XSETTINGS_INTERFACE,
+                                          "SetScaleFactorDone",
+                                          this,
+                                          SLOT(requestScaleFactor()));
 
+    QDBusServiceWatcher *watcher = new QDBusServiceWatcher(XSETTINGS_SERVICE, QDBusConnection::sessionBus(),
+                                                           QDBusServiceWatcher::WatchForRegistration, this);
+    connect(watcher, &QDBusServiceWatcher::serviceRegistered, this, &StartManagerDBusHandler::requestScaleFactor);
 }
 
+// 不等待回复，避免阻塞启动流程
 void StartManagerDBusHandler::markLaunched(QString desktopFile)
 {
-    QDBusInterface interface = QDBusInterface("org.deepin.dde.AlRecorder1", "/org/deepin/dde/AlRecorder1", "org.deepin.dde.AlRecorder1");
-    interface.call("MarkLaunched", desktopFile);
+    QDBusMessage msg = QDBusMessage::createMethodCall("org.deepin.dde.AlRecorder1", "/org/deepin/dde/AlRecorder1", "org.deepin.dde.AlRecorder1", "MarkLaunched");
+    msg << desktopFile;
+    QDBusConnection::sessionBus().asyncCall(msg);
 }
 
 QString StartManagerDBusHandler::getProxyMsg()
@@ -32,6 +53,41 @@ QString StartManagerDBusHandler::getProxyMsg()
 
 void StartManagerDBusHandler::addProxyProc(int32_t pid)
 {
-    QDBusInterface interface = QDBusInterface("org.deepin.dde.NetworkProxy1", "/org/deepin/dde/NetworkProxy1/App", "org.deepin.dde.NetworkProxy1.App", QDBusConnection::systemBus());
-    interface.call("AddProc", pid);
+    QDBusMessage msg = QDBusMessage::createMethodCall("org.deepin.dde.NetworkProxy1", "/org/deepin/dde/NetworkProxy1/App", "org.deepin.dde.NetworkProxy1.App", "AddProc");
+    msg << pid;
+    QDBusConnection::systemBus().asyncCall(msg);
+}
+
+double StartManagerDBusHandler::getScaleFactor()
+{
+    QDBusMessage reply = QDBusConnection::sessionBus().call(QDBusMessage::createMethodCall(XSETTINGS_SERVICE,
+                                                                                          XSETTINGS_PATH,
+                                                                                          XSETTINGS_INTERFACE,
+                                                                                          "GetScaleFactor"), QDBus::Block, 2);
+    if (reply.type() != QDBusMessage::ReplyMessage)
+        return 0;
+
+    QDBusReply<double> ret(reply);
+    double scale = ret.isValid() ? ret.value() : 1.0;
+    return scale > 0 ? scale : 1;
+}
+
+void StartManagerDBusHandler::requestScaleFactor()
+{
+    QDBusPendingCall call = QDBusConnection::sessionBus().asyncCall(QDBusMessage::createMethodCall(XSETTINGS_SERVICE,
+                                                                                                  XSETTINGS_PATH,
+                                                                                                  XSETTINGS_INTERFACE,
+                                                                                                  "GetScaleFactor"));
+    QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(call, this);
+    connect(watcher, &QDBusPendingCallWatcher::finished, this, [this](QDBusPendingCallWatcher *call) {
+        call->deleteLater();
+        QDBusPendingReply<double> reply = *call;
+        if (reply.isError()) {
+            qWarning() << "failed to get scale factor:" << reply.error().message();
+            return;
+        }
+
+        double scale = reply.value();
+        Q_EMIT scaleFactorChanged(scale > 0 ? scale : 1);
+    });
 }
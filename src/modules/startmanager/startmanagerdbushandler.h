@@ -18,9 +18,15 @@ public:
     QString getProxyMsg();
     void addProxyProc(int32_t pid);
 
+    // 同步获取XSettings的缩放比例，失败时返回0，可在工作线程中调用
+    double getScaleFactor();
+
 Q_SIGNALS:
+    void scaleFactorChanged(double scale);
 
 public Q_SLOTS:
+    // 异步获取缩放比例，结果通过scaleFactorChanged返回
+    void requestScaleFactor();
 };
 
 #endif // STARTMANAGERDBUSHANDLER_H
@@ -20,7 +20,12 @@ StartManagerSettings::StartManagerSettings(QObject *parent)
  , m_startConfig(Settings::ConfigPtr(configStartdde))
  , m_xsettingsConfig(Settings::ConfigPtr(configXsettings))
 {
-
+    if (m_xsettingsConfig) {
+        connect(m_xsettingsConfig, &DConfig::valueChanged, this, [this] (const QString &key) {
+            if (key == keyScaleFactor)
+                Q_EMIT scaleFactorChanged();
+        });
+    }
 }
 
 QVector<QString> StartManagerSettings::getUseProxyApps()
@@ -51,6 +56,15 @@ QVector<QString> StartManagerSettings::getDisableScalingApps()
     return ret;
 }
 
+int StartManagerSettings::getLaunchCoalesceWindow()
+{
+    int ret = defaultLaunchCoalesceWindow;
+    if (m_launchConfig) {
+        ret = m_launchConfig->value(keyLaunchCoalesceWindow, defaultLaunchCoalesceWindow).toInt();
+    }
+    return ret;
+}
+
 bool StartManagerSettings::getMemCheckerEnabled()
 {
     bool ret = false;
@@ -60,11 +74,74 @@ bool StartManagerSettings::getMemCheckerEnabled()
     return ret;
 }
 
+int StartManagerSettings::getAutostartDelay()
+{
+    int ret = 0;
+    if (m_startConfig) {
+        ret = m_startConfig->value(keyAutostartDelay).toInt();
+    }
+    return ret;
+}
+
+int StartManagerSettings::getAutostartParallel()
+{
+    int ret = defaultAutostartParallel;
+    if (m_startConfig) {
+        ret = m_startConfig->value(keyAutostartParallel, defaultAutostartParallel).toInt();
+    }
+    return ret;
+}
+
+bool StartManagerSettings::getPrewarmEnabled()
+{
+    bool ret = false;
+    if (m_startConfig) {
+        ret = m_startConfig->value(keyPrewarmEnabled).toBool();
+    }
+    return ret;
+}
+
+int StartManagerSettings::getPrewarmApps()
+{
+    int ret = defaultPrewarmApps;
+    if (m_startConfig) {
+        ret = m_startConfig->value(keyPrewarmApps, defaultPrewarmApps).toInt();
+    }
+    return ret;
+}
+
+int StartManagerSettings::getPrewarmBudget()
+{
+    int ret = defaultPrewarmBudget;
+    if (m_startConfig) {
+        ret = m_startConfig->value(keyPrewarmBudget, defaultPrewarmBudget).toInt();
+    }
+    return ret;
+}
+
+bool StartManagerSettings::getLoaderZygoteEnabled()
+{
+    bool ret = false;
+    if (m_startConfig) {
+        ret = m_startConfig->value(keyLoaderZygoteEnabled).toBool();
+    }
+    return ret;
+}
+
+int StartManagerSettings::getLoaderZygotePool()
+{
+    int ret = defaultLoaderZygotePool;
+    if (m_startConfig) {
+        ret = m_startConfig->value(keyLoaderZygotePool, defaultLoaderZygotePool).toInt();
+    }
+    return ret;
+}
+
 double StartManagerSettings::getScaleFactor()
 {
     double ret = 0;
     if (m_xsettingsConfig) {
-        m_xsettingsConfig->value(keyScaleFactor).toDouble();
+        ret = m_xsettingsConfig->value(keyScaleFactor).toDouble();
     }
     return ret;
 }
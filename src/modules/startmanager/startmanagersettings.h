@@ -33,15 +33,27 @@ public:
 
     QVector<QString> getUseProxyApps();
     QVector<QString> getDisableScalingApps();
+    int getLaunchCoalesceWindow();
 
     bool getMemCheckerEnabled();
 
+    int getAutostartDelay();
+    int getAutostartParallel();
+
+    bool getPrewarmEnabled();
+    int getPrewarmApps();
+    int getPrewarmBudget();
+
+    bool getLoaderZygoteEnabled();
+    int getLoaderZygotePool();
+
     double getScaleFactor();
 
     QString getDefaultTerminalExec();
     QString getDefaultTerminalExecArg();
 
 Q_SIGNALS:
+    void scaleFactorChanged();
 
 private:
     StartManagerSettings(QObject *parent = nullptr);
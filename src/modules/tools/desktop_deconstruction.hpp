@@ -44,15 +44,12 @@ static QSettings DesktopDeconstruction(const QString &desktop)
 
 #else
 
-#include <algorithm>
-#include <any>
 #include <fstream>
-#include <iostream>
-#include <memory>
-#include <regex>
+#include <iterator>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <utility>
-#include <variant>
 #include <vector>
 
 class DesktopDeconstruction
@@ -62,31 +59,39 @@ class DesktopDeconstruction
 
     struct Entry {
         typedef std::string Key;
-        typedef std::any Value;
+        typedef std::string Value;
         std::string name;
         std::vector<std::pair<Key, Value>> pairs;
     };
 
-    std::vector<std::shared_ptr<Entry>> _parse()
+    bool m_parsed = false;
+    std::vector<Entry> m_entrys;
+
+    // 一次读入整个文件并逐行切分，结果缓存在对象中，之后的查询不再读文件
+    const std::vector<Entry> &_parse()
     {
+        if (m_parsed) {
+            return m_entrys;
+        }
+        m_parsed = true;
+
         std::ifstream file(m_path);
         if (!file) {
-            return {};
+            return m_entrys;
         }
 
-        std::string line;
-        std::regex group_regex("\\[(.*?)\\]");
-        std::vector<std::shared_ptr<struct Entry>> entrys;
-        std::shared_ptr<Entry> currentEntry;
-        while (std::getline(file, line)) {
-            // 匹配 group，如果是，就进入判断
-            if (std::regex_match(line, group_regex)) {
-                std::smatch result;
-                if (std::regex_search(line, result, group_regex)) {
-                    currentEntry = std::make_shared<Entry>();
-                    currentEntry.get()->name = result.str();
-                    entrys.push_back(currentEntry);
-                }
+        const std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        std::string_view data(content);
+        Entry *currentEntry = nullptr;
+        while (!data.empty()) {
+            const size_t eol = data.find('\n');
+            std::string_view line = data.substr(0, eol);
+            data.remove_prefix(eol == std::string_view::npos ? data.size() : eol + 1);
+
+            // group 行，形如 [Desktop Entry]
+            if (line.size() >= 2 && line.front() == '[' && line.back() == ']') {
+                m_entrys.push_back({std::string(line.substr(1, line.size() - 2)), {}});
+                currentEntry = &m_entrys.back();
                 continue;
             }
             if (!currentEntry) {
@@ -99,13 +104,28 @@ class DesktopDeconstruction
             }
 
             const size_t index = line.find('=');
-            const std::string key = line.substr(0, index);
-            const std::any value = line.substr(index + 1, line.size());
-            currentEntry.get()->pairs.push_back({key, value});
+            if (index == std::string_view::npos) {
+                continue;
+            }
+            currentEntry->pairs.emplace_back(std::string(line.substr(0, index)), std::string(line.substr(index + 1)));
         }
-        file.close();
 
-        return entrys;
+        return m_entrys;
+    }
+
+    const std::string *find(const std::string &key)
+    {
+        for (const Entry &entry : _parse()) {
+            if (entry.name != m_group) {
+                continue;
+            }
+            for (const auto &pair : entry.pairs) {
+                if (pair.first == key) {
+                    return &pair.second;
+                }
+            }
+        }
+        return nullptr;
     }
 
 public:
@@ -129,30 +149,68 @@ public:
 
     std::vector<std::string> listKeys()
     {
-        std::vector<std::shared_ptr<Entry>> entrys{ _parse() };
         std::vector<std::string> result;
-        for (const std::shared_ptr<Entry> entry : entrys) {
-            for (const auto pair : entry.get()->pairs) {
+        for (const Entry &entry : _parse()) {
+            for (const auto &pair : entry.pairs) {
                 result.push_back(pair.first);
             }
         }
         return result;
     }
 
+    std::string string(const std::string &key)
+    {
+        const std::string *value = find(key);
+        return value ? *value : std::string();
+    }
+
+    // 以 ; 分隔的列表，忽略空项
+    std::vector<std::string> stringList(const std::string &key)
+    {
+        std::vector<std::string> result;
+        const std::string *value = find(key);
+        if (!value) {
+            return result;
+        }
+
+        std::string_view data(*value);
+        while (!data.empty()) {
+            const size_t index = data.find(';');
+            const std::string_view item = data.substr(0, index);
+            if (!item.empty()) {
+                result.emplace_back(item);
+            }
+            data.remove_prefix(index == std::string_view::npos ? data.size() : index + 1);
+        }
+        return result;
+    }
+
+    bool boolean(const std::string &key, bool defaultValue = false)
+    {
+        const std::string *value = find(key);
+        if (!value) {
+            return defaultValue;
+        }
+        if (*value == "true") {
+            return true;
+        }
+        if (*value == "false") {
+            return false;
+        }
+        return defaultValue;
+    }
+
     template <typename T>
     T value(const std::string key)
     {
-        std::vector<std::shared_ptr<Entry>> entrys{ _parse() };
-        for (const std::shared_ptr<Entry> entry : entrys) {
-            if (entry.get()->name == "[" + m_group + "]") {
-                for (const auto pair : entry.get()->pairs) {
-                    if (pair.first == key) {
-                        return std::any_cast<T>(pair.second);
-                    }
-                }
-            }
+        if constexpr (std::is_same_v<T, bool>) {
+            return boolean(key);
+        } else if constexpr (std::is_same_v<T, std::vector<std::string>>) {
+            return stringList(key);
+        } else {
+            static_assert(std::is_same_v<T, std::string>, "unsupported value type");
+            return string(key);
         }
-        return {};
     }
 };
 
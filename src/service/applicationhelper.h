@@ -2,14 +2,43 @@
 //
 // SPDX-License-Identifier: GPL-3.0-or-later
 
-#include "../modules/tools/desktop_deconstruction.hpp"
+#include "../lib/desktopentrycache.h"
 
+#include <QHash>
+#include <QSharedPointer>
 #include <QString>
+#include <QStringList>
+#include <QVariant>
 
 namespace modules {
 namespace ApplicationHelper {
 class Helper {
+    typedef QHash<QString, QString> Entry;
+
     QString m_file;
+    // [Desktop Entry]的全部键值，首次读取时解析，之后只在reload()后重新加载
+    mutable QSharedPointer<const Entry> m_entry;
+
+    QSharedPointer<const Entry> entry() const
+    {
+        if (m_entry)
+            return m_entry;
+
+        QSharedPointer<Entry> entry(new Entry);
+        KeyFile keyFile;
+        if (DesktopEntryCache::instance()->loadFile(m_file.toStdString(), keyFile)) {
+            for (const auto &item : keyFile.mappedEntries()) {
+                if (item.section != "Desktop Entry")
+                    continue;
+
+                entry->insert(QString::fromUtf8(item.key.data(), int(item.key.size())),
+                              QString::fromUtf8(item.value.data(), int(item.value.size())));
+            }
+        }
+
+        m_entry = entry;
+        return m_entry;
+    }
 
 public:
     Helper(const QString &desktop)
@@ -20,12 +49,18 @@ public:
 
     inline QString desktop() const { return m_file; }
 
+    // desktop文件发生变化时调用，下次读取时重新加载
+    void reload() { m_entry.reset(); }
+
     template <typename T>
     T value(const QString &key) const
     {
-        QSettings settings = DesktopDeconstruction(m_file);
-        settings.beginGroup("Desktop Entry");
-        return settings.value(key).value<T>();
+        const QSharedPointer<const Entry> desktopEntry = entry();
+        auto iter = desktopEntry->constFind(key);
+        if (iter == desktopEntry->constEnd())
+            return T();
+
+        return QVariant(iter.value()).value<T>();
     }
 
     QStringList categories() const
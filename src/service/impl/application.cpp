@@ -126,6 +126,11 @@ QString Application::Name(const QString &locale)
     return d->name(locale);
 }
 
+QDBusObjectPath Application::Launch(const QStringList &files)
+{
+    return createInstance(files)->path();
+}
+
 QDBusObjectPath Application::path() const
 {
     return QDBusObjectPath(QString("/org/deepin/dde/Application1/%1").arg(QString(QCryptographicHash::hash(id().toUtf8(), QCryptographicHash::Md5).toHex())));
@@ -145,23 +150,45 @@ QString Application::filePath() const
     return d->helper->desktop();
 }
 
+void Application::reloadDesktop()
+{
+    Q_D(Application);
+
+    d->helper->reload();
+}
+
 QSharedPointer<ApplicationInstance> Application::createInstance(QStringList files)
 {
     Q_D(Application);
 
-    d->instances << QSharedPointer<ApplicationInstance>(new ApplicationInstance(this, d->helper, files));
+    QSharedPointer<ApplicationInstance> instance(new ApplicationInstance(this, d->helper, files));
+    d->instances << instance;
 
-    connect(d->instances.last().get(), &ApplicationInstance::taskFinished, this, [=] {
-        for (auto it = d->instances.begin(); it != d->instances.end(); ++it) {
-            if ((*it).data() == sender()) {
-                d->instances.erase(it);
-                return;
-            }
-        }
-        qWarning() << "The instance should not be found!";
+    const QString hash = instance->hash();
+    connect(instance.get(), &ApplicationInstance::taskFinished, this, [=] {
+        if (!destoryInstance(hash))
+            qWarning() << "The instance should not be found!";
     });
 
-    return d->instances.last();
+    Q_EMIT instanceAdded(instance);
+    return instance;
+}
+
+bool Application::destoryInstance(QString hashId)
+{
+    Q_D(Application);
+
+    for (auto it = d->instances.begin(); it != d->instances.end(); ++it) {
+        if ((*it)->hash() == hashId) {
+            // 先从列表移除再通知，实例在最后一个引用释放时析构
+            QSharedPointer<ApplicationInstance> instance = *it;
+            d->instances.erase(it);
+            Q_EMIT instanceRemoved(hashId);
+            return true;
+        }
+    }
+
+    return false;
 }
 
 QString Application::prefix() const
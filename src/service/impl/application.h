@@ -54,13 +54,23 @@ public: // PROPERTIES
 
     QString filePath() const;
 
+    // desktop文件变化后丢弃已解析的内容
+    void reloadDesktop();
+
     QSharedPointer<ApplicationInstance> createInstance(QStringList files);
     QList<QSharedPointer<ApplicationInstance>>& getAllInstances();
     bool destoryInstance(QString hashId);
 
+Q_SIGNALS:
+    // 实例列表变化，用于维护ApplicationManager中的索引
+    void instanceAdded(const QSharedPointer<ApplicationInstance> &instance);
+    void instanceRemoved(const QString &hash);
+
 public Q_SLOTS: // METHODS
     QString Comment(const QString &locale);
     QString Name(const QString &locale);
+    // 由loader启动一个新实例，返回实例的对象路径
+    QDBusObjectPath Launch(const QStringList &files);
 };
 
 #endif /* A216803F_06DD_4F40_8FD1_5BAED85905BE */
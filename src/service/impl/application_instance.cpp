@@ -6,6 +6,11 @@
 #include "../applicationhelper.h"
 #include "application.h"
 #include "instanceadaptor.h"
+#include "../lib/environmentblock.h"
+#include "../../modules/startmanager/launchtrace.h"
+#include "../../modules/methods/wire.h"
+#include "../../modules/startmanager/startmanagersettings.h"
+#include "loader_zygote.h"
 
 #include <qdatetime.h>
 #include <QCryptographicHash>
@@ -15,6 +20,11 @@
 #include <QUuid>
 #include <QtConcurrent/QtConcurrent>
 
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+
 #ifdef DEFINE_LOADER_PATH
 #include "../../src/define.h"
 #endif
@@ -31,9 +41,12 @@ class ApplicationInstancePrivate
     QDateTime startupTime;
     QString m_id;
     uint32_t pid;
+    qint64 loaderPid;
+    bool unitStarted;   // loader由systemd单元启动
+    LaunchTrace::Record trace;
 
 public:
-    ApplicationInstancePrivate(ApplicationInstance* parent) : q_ptr(parent)
+    ApplicationInstancePrivate(ApplicationInstance* parent) : q_ptr(parent), pid(0), loaderPid(0), unitStarted(false)
     {
         startupTime = QDateTime::currentDateTime();
         m_id = QString(QCryptographicHash::hash(QUuid::createUuid().toByteArray(), QCryptographicHash::Md5).toHex());
@@ -49,8 +62,22 @@ public:
 
     void run()
     {
-#ifdef DEFINE_LOADER_PATH
+        // 启动信息随loader一起交付，loader不必再向AM请求；创建失败时loader走注册流程
+        const int taskFd = Methods::Wire::createSealedFd(Methods::Wire::encode(q_ptr->taskInfo(), false));
+        if (taskFd < 0)
+            qWarning() << "create task fd failed:" << strerror(errno);
+
+        // 交给zygote中已就绪的worker，实例的结束通过worker上报的quit处理
+        if (taskFd >= 0 && StartManagerSettings::instance()->getLoaderZygoteEnabled()
+                && LoaderZygote::instance()->submit(m_id, taskFd)) {
+            close(taskFd);
+            LaunchTrace::mark(trace, LaunchTrace::LoaderStarted);
+            LaunchTrace::mark(trace, LaunchTrace::TaskSent);
+            Q_EMIT q_ptr->taskDelivered();
+            return;
+        }
 
+#ifdef DEFINE_LOADER_PATH
         const QString task_hash{QString("DAM_TASK_HASH=%1").arg(m_id)};
         const QString task_type{"DAM_TASK_TYPE=freedesktop "};
         QProcess* p = new QProcess(q_ptr);
@@ -67,20 +94,43 @@ public:
         QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
         env.insert("DAM_TASK_HASH", m_id);
         env.insert("DAM_TASK_TYPE", "freedesktop");
+        if (taskFd >= 0)
+            env.insert(Methods::Wire::TaskFdEnv, QString::number(taskFd));
         p->setEnvironment(env.toStringList());
         p->start();
         p->waitForStarted();
+        if (taskFd >= 0)
+            close(taskFd);
         if (p->state() == QProcess::ProcessState::NotRunning) {
+            trace.error = p->error() == QProcess::FailedToStart ? ENOENT : ECHILD;
+            LaunchTrace::instance()->commit(trace);
             Q_EMIT q_ptr->taskFinished(p->exitCode());
+            return;
+        }
+        loaderPid = p->processId();
+        LaunchTrace::mark(trace, LaunchTrace::LoaderStarted);
+        if (taskFd >= 0) {
+            LaunchTrace::mark(trace, LaunchTrace::TaskSent);
+            Q_EMIT q_ptr->taskDelivered();
         }
 #else
+        // systemd启动的loader不是AM的子进程，拿不到fd，仍通过registe、instance领取启动信息
+        if (taskFd >= 0)
+            close(taskFd);
+
         qInfo() << "app manager load service:" << QString("org.deepin.dde.Application1.Instance@%1.service").arg(m_id);
         QDBusInterface systemd("org.freedesktop.systemd1", "/org/freedesktop/systemd1", "org.freedesktop.systemd1.Manager");
         QDBusReply<void> reply = systemd.call("StartUnit", QString("org.deepin.dde.Application1.Instance@%1.service").arg(m_id), "replace-irreversibly");
         if (!reply.isValid()) {
             qInfo() << reply.error();
-            q_ptr->deleteLater();
+            trace.error = ECHILD;
+            LaunchTrace::instance()->commit(trace);
+            // 实例由Application持有，通过taskFinished移除，不能直接deleteLater
+            Q_EMIT q_ptr->taskFinished(-1);
+            return;
         }
+        unitStarted = true;
+        LaunchTrace::mark(trace, LaunchTrace::LoaderStarted);
 #endif
     }
 
@@ -88,6 +138,10 @@ public:
     {
 #ifdef LOADER_PATH
 #else
+        // zygote的worker不属于实例单元，退出时没有单元需要停止
+        if (!unitStarted)
+            return;
+
         QDBusInterface systemd("org.freedesktop.systemd1", "/org/freedesktop/systemd1", "org.freedesktop.systemd1.Manager");
         qInfo() << systemd.call("StopUnit", QString("org.deepin.dde.Application1.Instance@%1.service").arg(m_id), "replace-irreversibly");
 #endif
@@ -102,6 +156,8 @@ public:
     void _success(const QString& data)
     {
         pid = data.toUInt();
+        LaunchTrace::mark(trace, LaunchTrace::ProcessStarted);
+        LaunchTrace::instance()->commit(trace);
     }
 };
 
@@ -114,6 +170,8 @@ ApplicationInstance::ApplicationInstance(Application* parent, QSharedPointer<mod
 
     d->application = parent;
     d->helper = helper;
+    d->trace.appId = parent->id();
+    LaunchTrace::mark(d->trace, LaunchTrace::InstanceCreated);
 
     QTimer::singleShot(0, this, [ = ] {
         QDBusConnection::sessionBus().registerObject(d->m_path, "org.deepin.dde.Application1.Instance", this);
@@ -167,15 +225,41 @@ Methods::Task ApplicationInstance::taskInfo() const
     task.arguments = m_files;
 
     // TODO: debug to display environment
-    task.environments.insert("DISPLAY", ":0");
-    auto sysEnv = QProcessEnvironment::systemEnvironment();
-    for (const auto& key : sysEnv.keys()) {
-        task.environments.insert(key, sysEnv.value(key));
-    }
+    // 会话环境在守护进程运行期间不变，只构造一次，之后各任务共享同一份数据
+    static const QMap<QString, QString> sessionEnvironments = [] {
+        QMap<QString, QString> envs;
+        envs.insert("DISPLAY", ":0");
+        const auto block = EnvironmentBlock::session();
+        for (char *const *env = block->envp(); *env; ++env) {
+            // 没有'='的条目与EnvironmentBlock一致，整条作为KEY，值为空
+            const char *sep = strchr(*env, '=');
+            if (!sep) {
+                envs.insert(QString::fromLocal8Bit(*env), QString());
+                continue;
+            }
+            envs.insert(QString::fromLocal8Bit(*env, int(sep - *env)), QString::fromLocal8Bit(sep + 1));
+        }
+        return envs;
+    }();
+    task.environments = sessionEnvironments;
 
     return task;
 }
 
+qint64 ApplicationInstance::loaderPid() const
+{
+    Q_D(const ApplicationInstance);
+
+    return d->loaderPid;
+}
+
+void ApplicationInstance::taskSent()
+{
+    Q_D(ApplicationInstance);
+
+    LaunchTrace::mark(d->trace, LaunchTrace::TaskSent);
+}
+
 void ApplicationInstance::Exit()
 {
     Q_D(ApplicationInstance);
@@ -38,9 +38,15 @@ public:  // PROPERTIES
     QDBusObjectPath path() const;
     QString         hash() const;
     Methods::Task   taskInfo() const;
+    // loader已取走启动信息
+    void            taskSent();
+    // 由AM直接启动的loader的pid，通过systemd或zygote启动时为0
+    qint64          loaderPid() const;
 
 Q_SIGNALS:
     void taskFinished(int exitCode) const;
+    // 启动信息已通过fd交给loader，之后不再接受对该实例的instance请求
+    void taskDelivered();
 
 public Q_SLOTS:  // METHODS
     void Exit();
@@ -5,6 +5,8 @@
 #include "application_manager.h"
 
 #include <unistd.h>
+#include <cerrno>
+#include <cstring>
 
 #include <QDBusMessage>
 #include <QDBusConnectionInterface>
@@ -22,7 +24,9 @@
 #include "../../modules/methods/quit.hpp"
 #include "../../modules/methods/registe.hpp"
 #include "../../modules/methods/task.hpp"
+#include "../../modules/methods/wire.h"
 #include "../../modules/startmanager/startmanager.h"
+#include "../../modules/startmanager/launchtrace.h"
 #include "application.h"
 #include "application_instance.h"
 #include "instanceadaptor.h"
@@ -39,6 +43,14 @@ ApplicationManagerPrivate::ApplicationManagerPrivate(ApplicationManager* parent)
     const QString socketPath{QString("/run/user/%1/dde-application-manager.socket").arg(getuid())};
     connect(&server, &Socket::Server::onReadyRead, this, &ApplicationManagerPrivate::recvClientData, Qt::QueuedConnection);
     server.listen(socketPath.toStdString());
+
+    // desktop文件变化时通知对应的应用重新加载
+    QDBusConnection::sessionBus().connect("org.deepin.dde.DFWatcher1",
+                                          "/org/deepin/dde/DFWatcher1",
+                                          "org.deepin.dde.DFWatcher1",
+                                          "Event",
+                                          this,
+                                          SLOT(onDesktopFileChanged(const QString &, int)));
 }
 
 ApplicationManagerPrivate::~ApplicationManagerPrivate()
@@ -54,90 +66,86 @@ bool ApplicationManagerPrivate::checkDMsgUid()
 /**
  * @brief ApplicationManagerPrivate::recvClientData 接受客户端数据，进行校验
  * @param socket 客户端套接字
- * @param data 接受到客户端数据
+ * @param id 连接id，回复时一并传给server，防止写到复用了同一fd的新连接
+ * @param data 接受到客户端数据，一个完整的Methods::Wire帧，按请求的格式回复
+ * @param pid 客户端进程，由SO_PEERCRED取得
+ * 这里的实例都由Application1.Launch创建。AM直接启动的loader（Debug构建）和zygote的worker
+ * 已通过密封fd拿到启动信息，只会发送success、quit；Release构建未启用zygote或zygote不可用时
+ * 经systemd单元启动loader，仍通过registe、instance领取启动信息。
+ * StartManager的Launch*直接创建应用进程，不经过loader
  */
-void ApplicationManagerPrivate::recvClientData(int socket, const std::vector<char>& data)
+void ApplicationManagerPrivate::recvClientData(int socket, quint64 id, const std::vector<char>& data, int pid)
 {
-    QByteArray jsonArray = data.data();
-    Methods::Basic basic;
-    Methods::fromJson(jsonArray, basic);
-    QByteArray tmpArray;
+    const bool json = Methods::Wire::isJson(data);
+    const QString type = Methods::Wire::messageType(data);
     do {
         // 运行实例
-        if (basic.type == "instance") {
+        if (type == "instance") {
             Methods::Instance instance;
-            Methods::fromJson(jsonArray, instance);
+            if (!Methods::Wire::decode(data, instance)) {
+                qWarning() << "invalid instance message from" << pid;
+                server.close(socket, id);
+                break;
+            }
 
             // 校验实例信息
-            auto find = tasks.find(instance.hash.toStdString());
-            if (find != tasks.end()) {
-                Methods::Task task = find->second->taskInfo();
-                Methods::toJson(tmpArray, task);
+            QSharedPointer<ApplicationInstance> pending = registry.takePendingTask(instance.hash);
+            if (pending) {
+                Methods::Task task = pending->taskInfo();
+                pending->taskSent();
 
                 // 通过校验，传入应用启动信息
-                write(socket, tmpArray.toStdString());
-                tasks.erase(find);
+                write(socket, id, Methods::Wire::encode(task, json));
                 break;
             }
         }
 
         // 退出
-        if (basic.type == "quit") {
+        if (type == "quit") {
             Methods::ProcessStatus quit;
-            Methods::fromJson(jsonArray, quit);
-            processInstanceStatus(quit);
-            server.close(socket);
+            if (Methods::Wire::decode(data, quit))
+                processInstanceStatus(quit, pid);
+            else
+                qWarning() << "invalid quit message from" << pid;
+            server.close(socket, id);
             std::cout << "client quit" << std::endl;
             break;
         }
 
         // 注册应用
-        if (basic.type == "registe") {
+        if (type == "registe") {
             Methods::Registe registe;
-            Methods::fromJson(jsonArray, registe);
+            const bool valid = Methods::Wire::decode(data, registe);
+            if (!valid)
+                qWarning() << "invalid registe message from" << pid;
             Methods::Registe result;
             result.state = false;
-            // std::lock_guard<std::mutex> lock(task_mutex);
-            for (auto it = tasks.begin(); it != tasks.end(); ++it) {
-                if (registe.hash == QString::fromStdString(it->first)) {
-                    result.state = true;
-                    result.hash = registe.hash;
-                    break;
-                }
+            if (valid && registry.hasPendingTask(registe.hash)) {
+                result.state = true;
+                result.hash = registe.hash;
             }
-            Methods::toJson(tmpArray, result);
-            write(socket, tmpArray.toStdString());
+            write(socket, id, Methods::Wire::encode(result, json));
             break;
         }
 
-        if (basic.type == "success") {
+        if (type == "success") {
             Methods::ProcessStatus processSuccess;
-            Methods::fromJson(jsonArray, processSuccess);
-            processInstanceStatus(processSuccess);
+            if (!Methods::Wire::decode(data, processSuccess)) {
+                qWarning() << "invalid success message from" << pid;
+                server.close(socket, id);
+                break;
+            }
+            processInstanceStatus(processSuccess, pid);
             std::cout << "client success" << std::endl;
             break;
         }
-        write(socket, jsonArray.toStdString());
+        write(socket, id, data);
     } while (false);
 }
 
-void ApplicationManagerPrivate::write(int socket, const std::vector<char>& data)
-{
-    std::vector<char> tmp = data;
-    tmp.push_back('\0');
-    server.write(socket, tmp);
-}
-
-void ApplicationManagerPrivate::write(int socket, const std::string& data)
-{
-    std::vector<char> result;
-    std::copy(data.cbegin(), data.cend(), std::back_inserter(result));
-    return write(socket, result);
-}
-
-void ApplicationManagerPrivate::write(int socket, const char c)
+void ApplicationManagerPrivate::write(int socket, quint64 id, const std::vector<char>& data)
 {
-    return write(socket, std::vector<char>(c));
+    server.write(socket, id, data);
 }
 
 void ApplicationManagerPrivate::init()
@@ -150,32 +158,41 @@ void ApplicationManagerPrivate::init()
     }
 }
 
-void ApplicationManagerPrivate::processInstanceStatus(Methods::ProcessStatus instanceStatus)
+void ApplicationManagerPrivate::processInstanceStatus(Methods::ProcessStatus instanceStatus, int pid)
 {
-    bool bFound = false;
+    QSharedPointer<ApplicationInstance> instance = registry.instance(instanceStatus.id);
+    if (!instance)
+        return;
 
-    auto application = applications.begin();
-    while (application != applications.end()) {
+    // 只接受该实例自己的loader上报的状态
+    if (instance->loaderPid() > 0 && instance->loaderPid() != pid) {
+        qWarning() << "instance status from unexpected process:" << pid << "hash:" << instanceStatus.id;
+        return;
+    }
 
-        auto instance = (*application)->getAllInstances().begin();
-        while (instance != (*application)->getAllInstances().end()) {
-            if ((*instance)->hash() == instanceStatus.id) {
-                bFound = true;
-            }
-            if (bFound) {
-                if (instanceStatus.type == "success") {
-                    (*instance)->Success(instanceStatus.data);
-                } else if (instanceStatus.type == "quit") {
-                    (*instance)->Exit();
-                    (*application)->getAllInstances().erase(instance);
-                } else {
-                    qWarning() << "instance tyep : " << instanceStatus.type << "not found";
-                }
-                return;
-            }
-            instance++;
+    if (instanceStatus.type == "success") {
+        instance->Success(instanceStatus.data);
+        registry.setInstancePid(instanceStatus.id, instance->getPid());
+    } else if (instanceStatus.type == "quit") {
+        instance->Exit();
+        if (Application *app = registry.owner(instanceStatus.id))
+            app->destoryInstance(instanceStatus.id);
+
+        registry.removeInstance(instanceStatus.id);
+    } else {
+        qWarning() << "instance tyep : " << instanceStatus.type << "not found";
+    }
+}
+
+void ApplicationManagerPrivate::onDesktopFileChanged(const QString &filePath, int event)
+{
+    Q_UNUSED(event);
+
+    for (const QSharedPointer<Application> &app : registry.applications()) {
+        if (app->filePath() == filePath) {
+            app->reloadDesktop();
+            break;
         }
-        application++;
     }
 }
 
@@ -192,6 +209,7 @@ ApplicationManager::ApplicationManager(QObject* parent)
     Q_D(ApplicationManager);
 
     connect(d->startManager, &StartManager::autostartChanged, this, &ApplicationManager::AutostartChanged);
+    connect(d->startManager, &StartManager::launchFinished, this, &ApplicationManager::LaunchFinished);
 }
 
 ApplicationManager::~ApplicationManager() {}
@@ -200,12 +218,33 @@ void ApplicationManager::addApplication(const QList<QSharedPointer<Application>>
 {
     Q_D(ApplicationManager);
 
-    d->applications = list;
+    for (const QSharedPointer<Application> &app : d->registry.applications())
+        app->disconnect(d);
+
+    d->registry.setApplications(list);
+    for (const QSharedPointer<Application> &app : list) {
+        Application *owner = app.data();
+        for (const QSharedPointer<ApplicationInstance> &instance : app->getAllInstances())
+            d->registry.addInstance(owner, instance);
+
+        connect(owner, &Application::instanceAdded, d, [d, owner](const QSharedPointer<ApplicationInstance> &instance) {
+            d->registry.addInstance(owner, instance);
+
+            // 启动信息已随fd交付，不能再被instance请求重放
+            const QString hash = instance->hash();
+            connect(instance.data(), &ApplicationInstance::taskDelivered, d, [d, hash] {
+                d->registry.takePendingTask(hash);
+            });
+        });
+        connect(owner, &Application::instanceRemoved, d, [d](const QString &hash) {
+            d->registry.removeInstance(hash);
+        });
+    }
 }
 
 /**
  * @brief ApplicationManager::launchAutostartApps 加载自启动应用
- * TODO 待优化点： 多个loader使用同一个套接字通信，串行执行，效率低
+ * 自启动应用由StartManager中的AutostartScheduler按阶段并行启动，这里不再处理
  */
 void ApplicationManager::launchAutostartApps()
 {
@@ -227,12 +266,8 @@ QDBusObjectPath ApplicationManager::GetInformation(const QString& id)
     if (!d->checkDMsgUid())
         return {};
 
-    for (const QSharedPointer<Application>& app : d->applications) {
-        if (app->id() == id) {
-            return app->path();
-        }
-    }
-    return {};
+    const QSharedPointer<Application> app = d->registry.application(id);
+    return app ? app->path() : QDBusObjectPath();
 }
 
 QList<QDBusObjectPath> ApplicationManager::GetInstances(const QString& id)
@@ -241,13 +276,8 @@ QList<QDBusObjectPath> ApplicationManager::GetInstances(const QString& id)
     if (!d->checkDMsgUid())
         return {};
 
-    for (const auto& app : d->applications) {
-        if (app->id() == id) {
-            return app->instances();
-        }
-    }
-
-    return {};
+    const QSharedPointer<Application> app = d->registry.application(id);
+    return app ? app->instances() : QList<QDBusObjectPath>();
 }
 
 bool ApplicationManager::AddAutostart(const QString &desktop)
@@ -330,6 +360,30 @@ bool ApplicationManager::IsAutostart(const QString &fileName)
     return true;
 }
 
+/**
+ * @brief ApplicationManager::launchReply 启动结果通过延迟回复返回给D-Bus调用方
+ * @return 不是D-Bus调用时返回空回调
+ */
+StartManager::LaunchCallback ApplicationManager::launchReply()
+{
+    if (!calledFromDBus())
+        return nullptr;
+
+    setDelayedReply(true);
+    const QDBusMessage msg = message();
+    QDBusConnection conn = connection();
+    return [msg, conn](qint64 pid, int error) {
+        if (pid > 0) {
+            conn.send(msg.createReply());
+        } else if (error == EINVAL) {
+            qWarning() << "invalid arguments";
+            conn.send(msg.createErrorReply(QDBusError::InvalidArgs, "invalid arguments"));
+        } else {
+            conn.send(msg.createErrorReply(QDBusError::Failed, QString("failed to launch app: %1").arg(strerror(error))));
+        }
+    };
+}
+
 void ApplicationManager::Launch(const QString &desktopFile, bool withMsgCheck)
 {
     Q_D(ApplicationManager);
@@ -341,12 +395,7 @@ void ApplicationManager::Launch(const QString &desktopFile, bool withMsgCheck)
         return;
     }
 
-    if (!d->startManager->launchApp(desktopFile)) {
-        if (calledFromDBus())
-            sendErrorReply(QDBusError::InvalidArgs, "invalid arguments");
-
-        qWarning() << "invalid arguments";
-    }
+    d->startManager->launchApp(desktopFile, launchReply());
 }
 
 
@@ -361,12 +410,7 @@ void ApplicationManager::LaunchApp(const QString &desktopFile, uint32_t timestam
         return;
     }
 
-    if (!d->startManager->launchApp(desktopFile, timestamp, files)) {
-        if (calledFromDBus())
-            sendErrorReply(QDBusError::InvalidArgs, "invalid arguments");
-
-        qWarning() << "invalid arguments";
-    }
+    d->startManager->launchApp(desktopFile, timestamp, files, launchReply());
 }
 
 void ApplicationManager::LaunchAppAction(const QString &desktopFile, const QString &action, uint32_t timestamp, bool withMsgCheck)
@@ -380,12 +424,7 @@ void ApplicationManager::LaunchAppAction(const QString &desktopFile, const QStri
         return;
     }
 
-    if (!d->startManager->launchAppAction(desktopFile, action, timestamp)) {
-        if (calledFromDBus())
-            sendErrorReply(QDBusError::InvalidArgs, "invalid arguments");
-
-        qWarning() << "invalid arguments";
-    }
+    d->startManager->launchAppAction(desktopFile, action, timestamp, launchReply());
 }
 
 void ApplicationManager::LaunchAppWithOptions(const QString &desktopFile, uint32_t timestamp, const QStringList &files, QVariantMap options)
@@ -399,12 +438,7 @@ void ApplicationManager::LaunchAppWithOptions(const QString &desktopFile, uint32
         return;
     }
 
-    if (!d->startManager->launchAppWithOptions(desktopFile, timestamp, files, options)) {
-        if (calledFromDBus())
-            sendErrorReply(QDBusError::InvalidArgs, "invalid arguments");
-
-        qWarning() << "invalid arguments";
-    }
+    d->startManager->launchAppWithOptions(desktopFile, timestamp, files, options, launchReply());
 }
 
 void ApplicationManager::RunCommand(const QString &exe, const QStringList &args)
@@ -445,13 +479,31 @@ void ApplicationManager::RunCommandWithOptions(const QString &exe, const QString
     }
 }
 
+/**
+ * @brief ApplicationManager::GetLaunchStatistics 调试接口，最近启动各阶段耗时的统计
+ * @return JSON，按应用id给出各阶段耗时(us)的p50/p90/p99/max
+ */
+QString ApplicationManager::GetLaunchStatistics()
+{
+    Q_D(ApplicationManager);
+    if (!d->checkDMsgUid()) {
+        if (calledFromDBus())
+            sendErrorReply(QDBusError::Failed, "The call failed");
+
+        qWarning() << "check msg failed...";
+        return QString();
+    }
+
+    return LaunchTrace::instance()->statistics();
+}
+
 QList<QDBusObjectPath> ApplicationManager::instances() const
 {
     Q_D(const ApplicationManager);
 
     QList<QDBusObjectPath> result;
 
-    for (const auto& app : d->applications) {
+    for (const auto& app : d->registry.applications()) {
         result += app->instances();
     }
 
@@ -463,7 +515,7 @@ QList<QDBusObjectPath> ApplicationManager::list() const
     Q_D(const ApplicationManager);
 
     QList<QDBusObjectPath> result;
-    for (const QSharedPointer<Application>& app : d->applications) {
+    for (const QSharedPointer<Application>& app : d->registry.applications()) {
         result << app->path();
     }
 
@@ -474,15 +526,7 @@ bool ApplicationManager::IsProcessExist(uint32_t pid)
 {
     Q_D(const ApplicationManager);
 
-    for (auto app : d->applications) {
-        for (auto instance : app->getAllInstances()) {
-            if (instance->getPid() == pid) {
-                return true;
-            }
-        }
-    }
-
-    return false;
+    return !d->registry.instanceByPid(pid).isNull();
 }
 
 #include "application_manager.moc"
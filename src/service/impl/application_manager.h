@@ -8,6 +8,7 @@
 #include "../../modules/startmanager/startmanager.h"
 #include "../../modules/socket/server.h"
 #include "../../modules/methods/process_status.hpp"
+#include "application_registry.h"
 
 #include <QObject>
 #include <QDBusObjectPath>
@@ -23,9 +24,8 @@ class ApplicationManagerPrivate : public QObject
     ApplicationManager *q_ptr = nullptr;
     Q_DECLARE_PUBLIC(ApplicationManager);
 
-    QList<QSharedPointer<Application>> applications;
+    ApplicationRegistry registry;
     Socket::Server server;
-    std::multimap<std::string, QSharedPointer<ApplicationInstance>> tasks;
     StartManager *startManager;
     std::vector<std::string>    virtualMachines;
     const std::string           virtualMachePath;
@@ -41,15 +41,15 @@ public:
     void init();
 
 private:
-    void recvClientData(int socket, const std::vector<char> &data);
+    void recvClientData(int socket, quint64 id, const std::vector<char> &data, int pid);
 
-    void write(int socket, const std::vector<char> &data);
+    // data为完整的Methods::Wire帧
+    void write(int socket, quint64 id, const std::vector<char> &data);
 
-    void write(int socket, const std::string &data);
+    void processInstanceStatus(Methods::ProcessStatus instanceStatus, int pid);
 
-    void write(int socket, const char c);
-
-    void processInstanceStatus(Methods::ProcessStatus instanceStatus);
+private Q_SLOTS:
+    void onDesktopFileChanged(const QString &filePath, int event);
 };
 
 class ApplicationManager : public QObject, public QDBusContext
@@ -69,6 +69,8 @@ public:
 
 Q_SIGNALS:
     void AutostartChanged(const QString &status, const QString &filePath);
+    // 启动请求完成，失败时pid为-1
+    void LaunchFinished(const QString &desktopFile, qint64 pid);
 
 public Q_SLOTS:
     bool AddAutostart(const QString &desktop);
@@ -81,6 +83,7 @@ public Q_SLOTS:
     void LaunchAppWithOptions(const QString &desktopFile, uint32_t timestamp, const QStringList &files, QVariantMap options);
     void RunCommand(const QString &exe, const QStringList &args);
     void RunCommandWithOptions(const QString &exe, const QStringList &args, const QVariantMap &options);
+    QString GetLaunchStatistics();
 
 protected:
     ApplicationManager(QObject *parent = nullptr);
@@ -91,6 +94,9 @@ protected:
     QDBusObjectPath GetInformation(const QString &id);
     QList<QDBusObjectPath> GetInstances(const QString &id);
     bool IsProcessExist(uint32_t pid);
+
+private:
+    StartManager::LaunchCallback launchReply();
 };
 
 #endif /* A2862DC7_5DA3_4129_9796_671D88015BED */
@@ -0,0 +1,129 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "application_registry.h"
+#include "application.h"
+#include "application_instance.h"
+
+void ApplicationRegistry::setApplications(const QList<QSharedPointer<Application>> &list)
+{
+    m_applications = list;
+    m_appsById.clear();
+    m_appsByPath.clear();
+    m_appsById.reserve(list.size());
+    m_appsByPath.reserve(list.size());
+
+    // id重复时与按顺序查找的结果一致，取第一个
+    for (const QSharedPointer<Application> &app : list) {
+        const QString id = app->id();
+        if (!m_appsById.contains(id))
+            m_appsById.insert(id, app);
+
+        const QString path = app->path().path();
+        if (!m_appsByPath.contains(path))
+            m_appsByPath.insert(path, app);
+    }
+}
+
+const QList<QSharedPointer<Application>> &ApplicationRegistry::applications() const
+{
+    return m_applications;
+}
+
+QSharedPointer<Application> ApplicationRegistry::application(const QString &id) const
+{
+    return m_appsById.value(id);
+}
+
+QSharedPointer<Application> ApplicationRegistry::applicationByPath(const QString &path) const
+{
+    return m_appsByPath.value(path);
+}
+
+void ApplicationRegistry::addInstance(Application *owner, const QSharedPointer<ApplicationInstance> &instance)
+{
+    const QString hash = instance->hash();
+    removeInstance(hash);
+
+    InstanceEntry entry;
+    entry.instance = instance;
+    entry.owner = owner;
+    entry.path = instance->path().path();
+    entry.pid = instance->getPid();
+    entry.pending = true;
+
+    m_instancePaths.insert(entry.path, hash);
+    if (entry.pid)
+        m_instancePids.insert(entry.pid, hash);
+
+    m_instances.insert(hash, entry);
+}
+
+void ApplicationRegistry::removeInstance(const QString &hash)
+{
+    auto iter = m_instances.find(hash);
+    if (iter == m_instances.end())
+        return;
+
+    m_instancePaths.remove(iter->path);
+    // pid可能已被新的实例复用
+    if (iter->pid && m_instancePids.value(iter->pid) == hash)
+        m_instancePids.remove(iter->pid);
+
+    m_instances.erase(iter);
+}
+
+void ApplicationRegistry::setInstancePid(const QString &hash, uint32_t pid)
+{
+    auto iter = m_instances.find(hash);
+    if (iter == m_instances.end() || iter->pid == pid)
+        return;
+
+    if (iter->pid && m_instancePids.value(iter->pid) == hash)
+        m_instancePids.remove(iter->pid);
+
+    iter->pid = pid;
+    if (pid)
+        m_instancePids.insert(pid, hash);
+}
+
+QSharedPointer<ApplicationInstance> ApplicationRegistry::instance(const QString &hash) const
+{
+    auto iter = m_instances.constFind(hash);
+    return iter == m_instances.constEnd() ? QSharedPointer<ApplicationInstance>() : iter->instance;
+}
+
+QSharedPointer<ApplicationInstance> ApplicationRegistry::instanceByPath(const QString &path) const
+{
+    auto iter = m_instancePaths.constFind(path);
+    return iter == m_instancePaths.constEnd() ? QSharedPointer<ApplicationInstance>() : instance(*iter);
+}
+
+QSharedPointer<ApplicationInstance> ApplicationRegistry::instanceByPid(uint32_t pid) const
+{
+    auto iter = m_instancePids.constFind(pid);
+    return iter == m_instancePids.constEnd() ? QSharedPointer<ApplicationInstance>() : instance(*iter);
+}
+
+Application *ApplicationRegistry::owner(const QString &hash) const
+{
+    auto iter = m_instances.constFind(hash);
+    return iter == m_instances.constEnd() ? nullptr : iter->owner;
+}
+
+bool ApplicationRegistry::hasPendingTask(const QString &hash) const
+{
+    auto iter = m_instances.constFind(hash);
+    return iter != m_instances.constEnd() && iter->pending;
+}
+
+QSharedPointer<ApplicationInstance> ApplicationRegistry::takePendingTask(const QString &hash)
+{
+    auto iter = m_instances.find(hash);
+    if (iter == m_instances.end() || !iter->pending)
+        return QSharedPointer<ApplicationInstance>();
+
+    iter->pending = false;
+    return iter->instance;
+}
@@ -0,0 +1,60 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef APPLICATION_REGISTRY_H
+#define APPLICATION_REGISTRY_H
+
+#include <QHash>
+#include <QList>
+#include <QSharedPointer>
+#include <QString>
+
+class Application;
+class ApplicationInstance;
+
+/**
+ * @brief The ApplicationRegistry class 应用和实例的索引
+ * 应用按id、对象路径索引，实例按hash、对象路径、pid索引，
+ * 实例创建、启动成功、退出时更新，查询都是常数时间，不随应用和实例数量增长。
+ * 只在主线程中使用。
+ */
+class ApplicationRegistry
+{
+public:
+    void setApplications(const QList<QSharedPointer<Application>> &list);
+    const QList<QSharedPointer<Application>> &applications() const;
+    QSharedPointer<Application> application(const QString &id) const;
+    QSharedPointer<Application> applicationByPath(const QString &path) const;
+
+    void addInstance(Application *owner, const QSharedPointer<ApplicationInstance> &instance);
+    void removeInstance(const QString &hash);
+    void setInstancePid(const QString &hash, uint32_t pid);
+
+    QSharedPointer<ApplicationInstance> instance(const QString &hash) const;
+    QSharedPointer<ApplicationInstance> instanceByPath(const QString &path) const;
+    QSharedPointer<ApplicationInstance> instanceByPid(uint32_t pid) const;
+    Application *owner(const QString &hash) const;
+
+    // 等待loader通过registe、instance领取启动信息的实例，启动信息已通过fd交付时由takePendingTask清除
+    bool hasPendingTask(const QString &hash) const;
+    QSharedPointer<ApplicationInstance> takePendingTask(const QString &hash);
+
+private:
+    struct InstanceEntry {
+        QSharedPointer<ApplicationInstance> instance;
+        Application *owner;
+        QString path;
+        uint32_t pid;
+        bool pending;
+    };
+
+    QList<QSharedPointer<Application>> m_applications;
+    QHash<QString, QSharedPointer<Application>> m_appsById;
+    QHash<QString, QSharedPointer<Application>> m_appsByPath;
+    QHash<QString, InstanceEntry> m_instances;  // 实例hash
+    QHash<QString, QString> m_instancePaths;    // 对象路径 -> 实例hash
+    QHash<uint32_t, QString> m_instancePids;    // pid -> 实例hash
+};
+
+#endif // APPLICATION_REGISTRY_H
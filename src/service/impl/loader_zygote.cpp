@@ -0,0 +1,130 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "loader_zygote.h"
+#include "../../modules/methods/wire.h"
+#include "../../modules/startmanager/startmanagersettings.h"
+
+#include <QDebug>
+#include <QProcess>
+
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+
+#ifdef DEFINE_LOADER_PATH
+#include "../../src/define.h"
+#endif
+
+namespace {
+
+#ifdef DEFINE_LOADER_PATH
+const char LoaderProgram[] = LOADER_PATH;
+#else
+const char LoaderProgram[] = "dde-application-loader";
+#endif
+
+} // namespace
+
+LoaderZygote *LoaderZygote::instance()
+{
+    static LoaderZygote instance;
+    return &instance;
+}
+
+LoaderZygote::LoaderZygote(QObject *parent)
+ : QObject(parent)
+ , m_process(nullptr)
+ , m_controlFd(-1)
+{
+
+}
+
+LoaderZygote::~LoaderZygote()
+{
+    stop();
+}
+
+bool LoaderZygote::submit(const QString &hash, int taskFd)
+{
+    if (m_controlFd < 0 && !start())
+        return false;
+
+    const std::string id = hash.toStdString();
+    if (Methods::Wire::sendTaskFd(m_controlFd, id, taskFd))
+        return true;
+
+    // zygote已退出但还没有收到finished，重启一次
+    if (errno == EPIPE || errno == ECONNRESET || errno == ENOTCONN) {
+        stop();
+        if (start() && Methods::Wire::sendTaskFd(m_controlFd, id, taskFd))
+            return true;
+    }
+
+    qWarning() << "submit task to loader zygote failed:" << strerror(errno);
+    return false;
+}
+
+bool LoaderZygote::start()
+{
+    int fds[2];
+    if (socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, fds) < 0) {
+        qWarning() << "create zygote control socket failed:" << strerror(errno);
+        return false;
+    }
+
+    // 只有zygote一端需要被继承
+    fcntl(fds[1], F_SETFD, 0);
+
+    QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
+    env.insert(Methods::Wire::ZygoteFdEnv, QString::number(fds[1]));
+    env.insert(Methods::Wire::ZygotePoolEnv, QString::number(StartManagerSettings::instance()->getLoaderZygotePool()));
+
+    QProcess *process = new QProcess(this);
+    process->setProgram(LoaderProgram);
+    process->setArguments({"--zygote"});
+    process->setProcessEnvironment(env);
+    process->setProcessChannelMode(QProcess::ForwardedChannels);
+    process->start();
+    const bool started = process->waitForStarted();
+    close(fds[1]);
+
+    if (!started) {
+        qWarning() << "start loader zygote failed:" << process->errorString();
+        close(fds[0]);
+        process->deleteLater();
+        return false;
+    }
+
+    connect(process, static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished), this, [this, process](int exitCode) {
+        qInfo() << "loader zygote exited, code:" << exitCode;
+        if (m_process == process)
+            stop();
+        else
+            process->deleteLater();
+    });
+
+    m_process = process;
+    m_controlFd = fds[0];
+    qInfo() << "loader zygote started, pid:" << process->processId();
+    return true;
+}
+
+void LoaderZygote::stop()
+{
+    // 关闭控制套接字后zygote和空闲的worker自行退出，已取得任务的worker不受影响
+    if (m_controlFd >= 0) {
+        close(m_controlFd);
+        m_controlFd = -1;
+    }
+
+    if (m_process) {
+        m_process->disconnect(this);
+        m_process->deleteLater();
+        m_process = nullptr;
+    }
+}
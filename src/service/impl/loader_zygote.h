@@ -0,0 +1,40 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef LOADER_ZYGOTE_H
+#define LOADER_ZYGOTE_H
+
+#include <QObject>
+
+class QProcess;
+
+/**
+ * @brief The LoaderZygote class 常驻的dde-application-loader
+ * 以--zygote启动loader，loader预先fork若干worker，worker已完成初始化并连接好AM。
+ * 启动应用时通过SOCK_SEQPACKET控制套接字把密封的任务fd交给空闲的worker，
+ * 不必再为每个实例创建和初始化loader进程。zygote退出后在下次提交时重新启动。
+ */
+class LoaderZygote : public QObject
+{
+    Q_OBJECT
+public:
+    static LoaderZygote *instance();
+
+    // 成功后zygote持有taskFd的副本，调用方仍需关闭自己的fd
+    bool submit(const QString &hash, int taskFd);
+
+private:
+    explicit LoaderZygote(QObject *parent = nullptr);
+    LoaderZygote(const LoaderZygote &);
+    LoaderZygote& operator= (const LoaderZygote &);
+    ~LoaderZygote();
+
+    bool start();
+    void stop();
+
+    QProcess *m_process;
+    int m_controlFd;
+};
+
+#endif // LOADER_ZYGOTE_H
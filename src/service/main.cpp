@@ -12,12 +12,14 @@
 #include "mime1adaptor.h"
 #include "settings.h"
 #include "dsysinfo.h"
+#include "desktopentrycache.h"
 #include "../modules/apps/appmanager.h"
 #include "../modules/launcher/launchermanager.h"
 #include "../modules/startmanager/startmanager.h"
 #include "../modules/mimeapp/mime_app.h"
 
 #include <QDir>
+#include <QTimer>
 #include <DLog>
 #include <pwd.h>
 
@@ -27,12 +29,13 @@ DCORE_USE_NAMESPACE
 #define ApplicationManagerServicePath "/org/deepin/dde/Application1/Manager"
 #define ApplicationManagerInterface   "org.deepin.dde.Application1.Manager"
 
-QFileInfoList scan(const QString &path)
+QStringList scan(const QString &path)
 {
-    QDir dir(path);
-    dir.setFilter(QDir::Files);
-    dir.setNameFilters({ "*.desktop" });
-    return dir.entryInfoList();
+    QStringList files;
+    for (const std::string &name : DesktopEntryCache::instance()->listDir(path.toStdString()))
+        files << path + QString::fromStdString(name);
+
+    return files;
 }
 
 // 扫描系统目录
@@ -41,33 +44,33 @@ QList<QSharedPointer<Application>> scanFiles()
 {
     QList<QSharedPointer<Application>> applications;
     auto apps = scan("/usr/share/applications/");
-    for (const QFileInfo &info : apps) {
+    for (const QString &file : apps) {
         applications << QSharedPointer<Application>(new Application(
             "freedesktop",
             Application::Type::System,
-            QSharedPointer<modules::ApplicationHelper::Helper>(new modules::ApplicationHelper::Helper(info.filePath()))
+            QSharedPointer<modules::ApplicationHelper::Helper>(new modules::ApplicationHelper::Helper(file))
         ));
     }
 
     struct passwd *user = getpwent();
     while (user) {
         auto userApps = scan(QString("%1/.local/share/applications/").arg(user->pw_dir));
-        for (const QFileInfo &info : userApps) {
+        for (const QString &file : userApps) {
             applications << QSharedPointer<Application>(new Application(
                 "freedesktop",
                 Application::Type::System,
-                QSharedPointer<modules::ApplicationHelper::Helper>(new modules::ApplicationHelper::Helper(info.filePath()))
+                QSharedPointer<modules::ApplicationHelper::Helper>(new modules::ApplicationHelper::Helper(file))
             ));
         }
         user = getpwent();
     }
     endpwent();
     auto linglong = scan("/persistent/linglong/entries/share/applications/");
-    for (const QFileInfo &info : linglong) {
+    for (const QString &file : linglong) {
         applications << QSharedPointer<Application>(new Application(
             "linglong",
             Application::Type::System,
-            QSharedPointer<modules::ApplicationHelper::Helper>(new modules::ApplicationHelper::Helper(info.filePath()))
+            QSharedPointer<modules::ApplicationHelper::Helper>(new modules::ApplicationHelper::Helper(file))
         ));
     }
 
@@ -137,6 +140,24 @@ int main(int argc, char *argv[])
 
     ApplicationManager::instance()->launchAutostartApps();
 
+    // 启动扫描的结果写回缓存，下次启动时不必再解析desktop文件
+    DesktopEntryCache::instance()->save();
+
+    // 之后解析或失效的条目在空闲一段时间后写回，退出时写回剩余的数据
+    QTimer *cacheSaveTimer = new QTimer(&app);
+    cacheSaveTimer->setSingleShot(true);
+    cacheSaveTimer->setInterval(10 * 1000);
+    QObject::connect(cacheSaveTimer, &QTimer::timeout, [] {
+        DesktopEntryCache::instance()->save();
+    });
+    DesktopEntryCache::instance()->setChangedCallback([cacheSaveTimer] {
+        QMetaObject::invokeMethod(cacheSaveTimer, "start", Qt::QueuedConnection);
+    });
+    QObject::connect(&app, &QCoreApplication::aboutToQuit, [] {
+        DesktopEntryCache::instance()->setChangedCallback(nullptr);
+        DesktopEntryCache::instance()->save();
+    });
+
     MimeApp* mimeApp = new MimeApp;
 
     new Mime1Adaptor(mimeApp);